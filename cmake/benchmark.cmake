@@ -0,0 +1,53 @@
+option(BUILD_BENCHMARKS "Build the Google Benchmark microbenchmarks" OFF)
+
+message(STATUS "Build benchmarks: " ${BUILD_BENCHMARKS})
+
+if(NOT BUILD_BENCHMARKS)
+    return()
+endif()
+
+set(FETCHCONTENT_QUIET OFF)
+
+include(FetchContent)
+
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+FetchContent_Declare(
+    googlebenchmark
+    GIT_REPOSITORY https://github.com/google/benchmark.git
+    GIT_TAG v1.9.1
+    EXCLUDE_FROM_ALL
+)
+
+FetchContent_MakeAvailable(googlebenchmark)
+
+set(BENCHMARK_OUTPUT_DIRECTORY "${PROJECT_BINARY_DIR}/benchmark-results" CACHE PATH "Path for the JSON benchmark results")
+
+function(make_benchmark benchname sources libraries)
+    set(BENCH_NAME "bench_${benchname}")
+
+    add_executable(${BENCH_NAME} ${sources})
+
+    target_link_libraries(${BENCH_NAME}
+        PRIVATE
+        ${libraries}
+        benchmark::benchmark
+        benchmark::benchmark_main)
+
+    target_compile_definitions(${BENCH_NAME}
+        PRIVATE
+        IP_TEST_DATA_DIR="${PROJECT_SOURCE_DIR}/test_data")
+
+    # Results of two builds can be diffed with compare.py from Google Benchmark.
+    add_custom_target(${BENCH_NAME}_json
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${BENCHMARK_OUTPUT_DIRECTORY}
+        COMMAND ${BENCH_NAME}
+        --benchmark_out=${BENCHMARK_OUTPUT_DIRECTORY}/${BENCH_NAME}.json
+        --benchmark_out_format=json
+        DEPENDS ${BENCH_NAME}
+        WORKING_DIRECTORY ${PROJECT_BINARY_DIR}
+        COMMENT "Running ${BENCH_NAME}"
+        VERBATIM
+    )
+endfunction()
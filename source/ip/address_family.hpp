@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ipv4.hpp"
+#include "ipv6.hpp"
+#include "parser.hpp"
+
+namespace ip
+{
+
+// Text conversions of an address family, the extension point the readers
+// and the printer are written against.
+template <typename Address>
+struct AddressFamily;
+
+template <>
+struct AddressFamily<IPv4>
+{
+    static constexpr size_t kMaxLength = kMaxIPv4Length;
+
+    static const char* Parse(const char* first, const char* last,
+                             IPv4& ip) noexcept
+    {
+        return ParseIPv4(first, last, ip);
+    }
+
+    static char* Format(const IPv4& ip, char* out) noexcept
+    {
+        return FormatIPv4(ip, out);
+    }
+};
+
+template <>
+struct AddressFamily<IPv6>
+{
+    static constexpr size_t kMaxLength = kMaxIPv6Length;
+
+    static const char* Parse(const char* first, const char* last,
+                             IPv6& ip) noexcept
+    {
+        return ParseIPv6(first, last, ip);
+    }
+
+    static char* Format(const IPv6& ip, char* out) noexcept
+    {
+        return FormatIPv6(ip, out);
+    }
+};
+
+}  // namespace ip
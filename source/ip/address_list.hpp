@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace ip
+{
+
+// Non-owning view over contiguous addresses of one family, e.g. a slice of a
+// sorted IpList.
+template <typename Address>
+class AddressListView final
+{
+   public:
+    AddressListView() noexcept = default;
+
+    AddressListView(const Address* data, size_t size) noexcept
+        : data_{data}, size_{size}
+    {
+    }
+
+    // Implicit so that owning lists can be passed wherever a view is taken.
+    AddressListView(const std::vector<Address>& addresses) noexcept
+        : AddressListView{addresses.data(), addresses.size()}
+    {
+    }
+
+    const Address* begin() const noexcept { return data_; }
+    const Address* end() const noexcept { return data_ + size_; }
+
+    const Address* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const Address& operator[](size_t index) const noexcept
+    {
+        return data_[index];
+    }
+
+   private:
+    const Address* data_{nullptr};
+    size_t size_{0};
+};
+
+}  // namespace ip
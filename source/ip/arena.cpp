@@ -0,0 +1,77 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace ip
+{
+
+IpArena::IpArena(size_t block_size) noexcept
+    : block_size_{std::max<size_t>(block_size, 1)}
+{
+}
+
+IpArena::~IpArena() { Release(0); }
+
+IPv4* IpArena::Allocate(size_t count)
+{
+    if (blocks_.empty() || blocks_.back().size - used_ < count)
+    {
+        const auto size = std::max(block_size_, count);
+
+        blocks_.reserve(blocks_.size() + 1);
+        blocks_.push_back({std::allocator<IPv4>{}.allocate(size), size});
+        used_ = 0;
+    }
+
+    last_offset_ = used_;
+    used_ += count;
+
+    return blocks_.back().data + last_offset_;
+}
+
+void IpArena::Shrink(const IPv4* data, size_t count) noexcept
+{
+    if (!blocks_.empty() && data == blocks_.back().data + last_offset_)
+    {
+        used_ = std::min(used_, last_offset_ + count);
+    }
+}
+
+void IpArena::Reset() noexcept
+{
+    if (blocks_.size() > 1)
+    {
+        std::swap(blocks_.front(), blocks_.back());
+        Release(1);
+    }
+
+    used_ = 0;
+    last_offset_ = 0;
+}
+
+void IpArena::Release(size_t first_block) noexcept
+{
+    for (size_t block = first_block; block < blocks_.size(); ++block)
+    {
+        std::allocator<IPv4>{}.deallocate(blocks_[block].data,
+                                          blocks_[block].size);
+    }
+
+    blocks_.resize(first_block);
+}
+
+size_t IpArena::Capacity() const noexcept
+{
+    size_t capacity = 0;
+
+    for (const auto& block : blocks_)
+    {
+        capacity += block.size;
+    }
+
+    return capacity;
+}
+
+}  // namespace ip
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+// Monotonic storage for result lists. Allocations are carved from large
+// blocks and released all at once, so building many results costs a few
+// big allocations instead of repeated vector growth, and views into the
+// arena stay valid until Reset or destruction.
+class IpArena final
+{
+   public:
+    static constexpr size_t kDefaultBlockSize = size_t{1} << 20;
+
+    explicit IpArena(size_t block_size = kDefaultBlockSize) noexcept;
+
+    IpArena(const IpArena&) = delete;
+    IpArena& operator=(const IpArena&) = delete;
+
+    ~IpArena();
+
+    // Returns uninitialised room for `count` addresses.
+    IPv4* Allocate(size_t count);
+
+    // Gives the unused tail of the latest allocation back to the arena, so a
+    // result can be allocated for its upper bound and trimmed once known.
+    void Shrink(const IPv4* data, size_t count) noexcept;
+
+    // Invalidates every allocation. The last block is kept, so an arena
+    // reused for results of similar size stops allocating.
+    void Reset() noexcept;
+
+    // Addresses reserved from the system so far.
+    size_t Capacity() const noexcept;
+
+   private:
+    void Release(size_t first_block) noexcept;
+
+    struct Block
+    {
+        IPv4* data;
+        size_t size;
+    };
+
+    size_t block_size_;
+    std::vector<Block> blocks_;
+    // Addresses handed out from the last block, and where the latest
+    // allocation started in it.
+    size_t used_{0};
+    size_t last_offset_{0};
+};
+
+}  // namespace ip
@@ -0,0 +1,83 @@
+#include "arena.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using ip::IpArena;
+
+TEST(IpArenaTest, ShouldPlaceAllocationsBackToBackWithinBlock)
+{
+    // Arrange
+    IpArena arena{16};
+
+    // Act
+    const auto* first = arena.Allocate(4);
+    const auto* second = arena.Allocate(4);
+
+    // Assert
+    EXPECT_EQ(second, first + 4);
+    EXPECT_EQ(arena.Capacity(), 16U);
+}
+
+TEST(IpArenaTest, ShouldReuseTailWhenLatestAllocationIsShrunk)
+{
+    // Arrange
+    IpArena arena{16};
+    const auto* first = arena.Allocate(10);
+
+    // Act
+    arena.Shrink(first, 3);
+    const auto* second = arena.Allocate(10);
+
+    // Assert
+    EXPECT_EQ(second, first + 3);
+    EXPECT_EQ(arena.Capacity(), 16U);
+}
+
+TEST(IpArenaTest, ShouldIgnoreShrinkWhenAllocationIsNotLatest)
+{
+    // Arrange
+    IpArena arena{16};
+    const auto* first = arena.Allocate(4);
+    const auto* second = arena.Allocate(4);
+
+    // Act
+    arena.Shrink(first, 0);
+    const auto* third = arena.Allocate(4);
+
+    // Assert
+    EXPECT_EQ(third, second + 4);
+}
+
+TEST(IpArenaTest, ShouldAllocateDedicatedBlockWhenRequestExceedsBlockSize)
+{
+    // Arrange
+    IpArena arena{16};
+    arena.Allocate(8);
+
+    // Act
+    arena.Allocate(100);
+
+    // Assert
+    EXPECT_EQ(arena.Capacity(), 116U);
+}
+
+TEST(IpArenaTest, ShouldKeepLastBlockForReuseWhenReset)
+{
+    // Arrange
+    IpArena arena{16};
+    arena.Allocate(8);
+    const auto* large = arena.Allocate(100);
+
+    // Act
+    arena.Reset();
+    const auto* reused = arena.Allocate(100);
+
+    // Assert
+    EXPECT_EQ(reused, large);
+    EXPECT_EQ(arena.Capacity(), 100U);
+}
+
+}  // namespace
@@ -0,0 +1,484 @@
+#include "async_reader.hpp"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.hpp"
+#include "file_descriptor.hpp"
+#include "utils.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+[[noreturn]] void ThrowSystemError(int error, const std::string& what)
+{
+    throw std::system_error(error, std::generic_category(), what);
+}
+
+[[noreturn]] void ThrowSystemError(const std::string& what)
+{
+    ThrowSystemError(errno, what);
+}
+
+// Owns a memory mapping of the io_uring rings.
+class Mapping final
+{
+   public:
+    Mapping() noexcept = default;
+
+    Mapping(int fd, size_t size, off_t offset)
+        : data_{::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, offset)},
+          size_{size}
+    {
+        if (data_ == MAP_FAILED)
+        {
+            data_ = nullptr;
+            ThrowSystemError("Failed to map an io_uring");
+        }
+    }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping()
+    {
+        if (data_ != nullptr)
+        {
+            ::munmap(data_, size_);
+        }
+    }
+
+    template <typename T>
+    T* At(uint32_t offset) const noexcept
+    {
+        return reinterpret_cast<T*>(static_cast<char*>(data_) + offset);
+    }
+
+   private:
+    void* data_{nullptr};
+    size_t size_{0};
+};
+
+// Minimal io_uring over the raw system calls, reading blocks of one file into
+// a fixed set of slots; the completion of a read carries its slot number.
+class Ring final
+{
+   public:
+    explicit Ring(uint32_t entries)
+    {
+        io_uring_params params{};
+
+        fd_ = FileDescriptor{static_cast<int>(
+            ::syscall(__NR_io_uring_setup, entries, &params))};
+
+        if (fd_.Get() < 0)
+        {
+            ThrowSystemError("Failed to set up an io_uring");
+        }
+
+        const auto sq_size =
+            params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        const auto cq_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        // Since Linux 5.4 both rings share a single mapping.
+        if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+        {
+            sq_ring_.emplace(fd_.Get(), std::max(sq_size, cq_size),
+                             IORING_OFF_SQ_RING);
+        }
+        else
+        {
+            sq_ring_.emplace(fd_.Get(), sq_size, IORING_OFF_SQ_RING);
+            cq_ring_.emplace(fd_.Get(), cq_size, IORING_OFF_CQ_RING);
+        }
+
+        sqes_.emplace(fd_.Get(), params.sq_entries * sizeof(io_uring_sqe),
+                      IORING_OFF_SQES);
+
+        const auto& sq = *sq_ring_;
+        const auto& cq = cq_ring_ ? *cq_ring_ : *sq_ring_;
+
+        sq_tail_ = sq.At<uint32_t>(params.sq_off.tail);
+        sq_mask_ = *sq.At<uint32_t>(params.sq_off.ring_mask);
+        sq_array_ = sq.At<uint32_t>(params.sq_off.array);
+        cq_head_ = cq.At<uint32_t>(params.cq_off.head);
+        cq_tail_ = cq.At<uint32_t>(params.cq_off.tail);
+        cq_mask_ = *cq.At<uint32_t>(params.cq_off.ring_mask);
+        cqes_ = cq.At<io_uring_cqe>(params.cq_off.cqes);
+    }
+
+    // Waits for the reads still in flight, which write into buffers owned by
+    // the caller.
+    ~Ring()
+    {
+        while (in_flight_ > 0)
+        {
+            if (!Enter(0, 1))
+            {
+                break;
+            }
+
+            Reap([](uint64_t, int32_t) {});
+        }
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    void Read(int fd, iovec& buffer, uint64_t offset, uint64_t slot)
+    {
+        const auto tail = *sq_tail_;
+        const auto index = tail & sq_mask_;
+        auto& sqe = sqes_->At<io_uring_sqe>(0)[index];
+
+        sqe = io_uring_sqe{};
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uintptr_t>(&buffer);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = slot;
+
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        if (!Enter(1, 0))
+        {
+            ThrowSystemError("Failed to submit a read");
+        }
+
+        ++in_flight_;
+    }
+
+    // Blocks until at least one read has completed, then calls
+    // complete(slot, result) for every completed read.
+    template <typename Complete>
+    void Wait(const Complete& complete)
+    {
+        if (!Enter(0, 1))
+        {
+            ThrowSystemError("Failed to wait for a read");
+        }
+
+        Reap(complete);
+    }
+
+   private:
+    bool Enter(uint32_t to_submit, uint32_t min_complete) const noexcept
+    {
+        const auto flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0U;
+
+        while (::syscall(__NR_io_uring_enter, fd_.Get(), to_submit,
+                         min_complete, flags, nullptr, 0) < 0)
+        {
+            if (errno != EINTR)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template <typename Complete>
+    void Reap(const Complete& complete)
+    {
+        auto head = *cq_head_;
+        const auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head)
+        {
+            const auto& cqe = cqes_[head & cq_mask_];
+            const auto slot = cqe.user_data;
+            const auto result = cqe.res;
+
+            --in_flight_;
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            complete(slot, result);
+        }
+    }
+
+    FileDescriptor fd_;
+    std::optional<Mapping> sq_ring_;
+    std::optional<Mapping> cq_ring_;
+    std::optional<Mapping> sqes_;
+
+    uint32_t* sq_tail_{nullptr};
+    uint32_t sq_mask_{0};
+    uint32_t* sq_array_{nullptr};
+    uint32_t* cq_head_{nullptr};
+    uint32_t* cq_tail_{nullptr};
+    uint32_t cq_mask_{0};
+    io_uring_cqe* cqes_{nullptr};
+
+    size_t in_flight_{0};
+};
+
+struct Slot
+{
+    std::unique_ptr<char[]> data;
+    iovec buffer{};
+    uint64_t offset{0};
+    size_t size{0};
+    size_t filled{0};
+    bool done{false};
+};
+
+FileDescriptor OpenForReading(const std::string& path)
+{
+    FileDescriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+
+    if (file.Get() < 0)
+    {
+        ThrowSystemError("Failed to open " + path);
+    }
+
+    return file;
+}
+
+// Block n is read into slot n % queue_depth, which is resubmitted for block
+// n + queue_depth once block n has been consumed, so blocks are consumed in
+// file order while the following ones are read. Returns false, having read
+// nothing, when the kernel offers no io_uring.
+bool ReadWithRing(int fd, size_t file_size, const BlockConsumer& consume,
+                  const AsyncReadOptions& options, const std::string& path)
+{
+    const auto block_size = options.block_size;
+    const auto blocks = (file_size + block_size - 1) / block_size;
+
+    std::vector<Slot> slots(std::min(options.queue_depth, blocks));
+
+    // Declared after the slots, so reads still in flight after an error are
+    // waited for before their buffers are freed.
+    std::optional<Ring> ring;
+
+    try
+    {
+        ring.emplace(static_cast<uint32_t>(options.queue_depth));
+    }
+    catch (const std::system_error&)
+    {
+        return false;
+    }
+
+    const auto submit = [&ring, fd](Slot& slot, uint64_t slot_index)
+    {
+        slot.buffer.iov_base = slot.data.get() + slot.filled;
+        slot.buffer.iov_len = slot.size - slot.filled;
+        ring->Read(fd, slot.buffer, slot.offset + slot.filled, slot_index);
+    };
+
+    const auto start = [&slots, &submit, block_size, file_size](size_t block)
+    {
+        auto& slot = slots[block % slots.size()];
+
+        if (!slot.data)
+        {
+            slot.data = std::make_unique<char[]>(block_size);
+        }
+
+        slot.offset = block * block_size;
+        slot.size = std::min(block_size, file_size - slot.offset);
+        slot.filled = 0;
+        slot.done = false;
+        submit(slot, block % slots.size());
+    };
+
+    const auto complete =
+        [&slots, &submit, &path](uint64_t slot_index, int32_t result)
+    {
+        auto& slot = slots[slot_index];
+
+        if (result < 0)
+        {
+            ThrowSystemError(-result, "Failed to read " + path);
+        }
+
+        slot.filled += static_cast<size_t>(result);
+
+        // A short read is continued, unless the file was truncated meanwhile.
+        if (result > 0 && slot.filled < slot.size)
+        {
+            submit(slot, slot_index);
+            return;
+        }
+
+        slot.done = true;
+    };
+
+    for (size_t block = 0; block < slots.size(); ++block)
+    {
+        start(block);
+    }
+
+    for (size_t block = 0; block < blocks; ++block)
+    {
+        auto& slot = slots[block % slots.size()];
+
+        while (!slot.done)
+        {
+            ring->Wait(complete);
+        }
+
+        consume({slot.data.get(), slot.filled});
+
+        if (block + slots.size() < blocks)
+        {
+            start(block + slots.size());
+        }
+    }
+
+    return true;
+}
+
+// A prefetch thread reads blocks into buffers recycled by the calling thread,
+// which bounds memory to queue_depth + 1 blocks.
+void ReadWithThread(int fd, const BlockConsumer& consume,
+                    const AsyncReadOptions& options, const std::string& path)
+{
+    BoundedQueue<std::string> free_blocks{options.queue_depth + 1};
+    BoundedQueue<std::string> filled_blocks{options.queue_depth + 1};
+
+    for (size_t block = 0; block <= options.queue_depth; ++block)
+    {
+        free_blocks.Push({});
+    }
+
+    std::exception_ptr error;
+
+    std::thread prefetcher{
+        [&]
+        {
+            try
+            {
+                while (auto block = free_blocks.Pop())
+                {
+                    block->resize(options.block_size);
+
+                    const auto count =
+                        ::read(fd, block->data(), block->size());
+
+                    if (count < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            free_blocks.Push(std::move(*block));
+                            continue;
+                        }
+
+                        ThrowSystemError("Failed to read " + path);
+                    }
+
+                    if (count == 0)
+                    {
+                        break;
+                    }
+
+                    block->resize(static_cast<size_t>(count));
+
+                    if (!filled_blocks.Push(std::move(*block)))
+                    {
+                        break;
+                    }
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            filled_blocks.Close();
+        }};
+
+    try
+    {
+        while (auto block = filled_blocks.Pop())
+        {
+            consume(*block);
+            free_blocks.Push(std::move(*block));
+        }
+    }
+    catch (...)
+    {
+        free_blocks.Close();
+        filled_blocks.Close();
+        prefetcher.join();
+        throw;
+    }
+
+    prefetcher.join();
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace
+
+ReadBackend ReadFileBlocks(const std::string& path,
+                           const BlockConsumer& consume,
+                           const AsyncReadOptions& options)
+{
+    AsyncReadOptions checked = options;
+    checked.block_size = std::max<size_t>(checked.block_size, 1);
+    checked.queue_depth = std::max<size_t>(checked.queue_depth, 1);
+
+    const auto file = OpenForReading(path);
+
+    struct stat file_stat{};
+
+    if (::fstat(file.Get(), &file_stat) != 0)
+    {
+        ThrowSystemError("Failed to stat " + path);
+    }
+
+    // Reads at explicit offsets need the size up front, so pipes and other
+    // special files are read sequentially.
+    if (checked.backend == ReadBackend::kIoUring &&
+        S_ISREG(file_stat.st_mode) &&
+        ReadWithRing(file.Get(), static_cast<size_t>(file_stat.st_size),
+                     consume, checked, path))
+    {
+        return ReadBackend::kIoUring;
+    }
+
+    ReadWithThread(file.Get(), consume, checked, path);
+
+    return ReadBackend::kThread;
+}
+
+IpList ReadFirstIpFromFile(const std::string& path,
+                           const AsyncReadOptions& options)
+{
+    IncrementalReader reader;
+
+    ReadFileBlocks(
+        path, [&reader](std::string_view block) { reader.Read(block); },
+        options);
+
+    return reader.Finish();
+}
+
+}  // namespace ip
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+enum class ReadBackend
+{
+    // Several reads in flight on an io_uring instance (Linux 5.1+).
+    kIoUring,
+    // A prefetch thread reading ahead into a bounded queue of blocks.
+    kThread
+};
+
+struct AsyncReadOptions
+{
+    size_t block_size{size_t{1} << 20};
+    // Reads in flight, or blocks read ahead by the prefetch thread.
+    size_t queue_depth{4};
+    // io_uring falls back to the prefetch thread when the kernel does not
+    // offer it or the input is not a regular file.
+    ReadBackend backend{ReadBackend::kIoUring};
+};
+
+using BlockConsumer = std::function<void(std::string_view)>;
+
+// Calls consume() with consecutive blocks of the file at `path`, in file
+// order, while the next blocks are being read. Returns the backend actually
+// used. Throws std::system_error when the file cannot be read; an exception
+// thrown by consume() stops the reads and is rethrown.
+ReadBackend ReadFileBlocks(const std::string& path,
+                           const BlockConsumer& consume,
+                           const AsyncReadOptions& options = {});
+
+// Reads the first address of every line like BufferReader, parsing every
+// block while the next ones are being read.
+IpList ReadFirstIpFromFile(const std::string& path,
+                           const AsyncReadOptions& options = {});
+
+}  // namespace ip
@@ -0,0 +1,149 @@
+#include "async_reader.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+
+#include "utils.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+constexpr std::string_view kLines =
+    "192.168.1.1\t1\t0\n"
+    "not an address\n"
+    "10.0.0.1\t2\t3\n"
+    "\n"
+    "1.2.3.4\n"
+    "255.255.255.255\tlast line without a newline";
+
+class AsyncReaderTest
+    : public ::testing::TestWithParam<std::tuple<ip::ReadBackend, size_t>>
+{
+   protected:
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    void SetUpFile(std::string_view content)
+    {
+        std::ofstream file{path_, std::ios::binary};
+        file << content;
+    }
+
+    ip::AsyncReadOptions Options() const
+    {
+        ip::AsyncReadOptions options;
+        options.backend = std::get<0>(GetParam());
+        options.block_size = std::get<1>(GetParam());
+        options.queue_depth = kQueueDepth;
+
+        return options;
+    }
+
+    static constexpr size_t kQueueDepth = 3;
+
+    std::string path_{::testing::TempDir() + "async_reader_test.tsv"};
+};
+
+TEST_P(AsyncReaderTest, ShouldDeliverFileContentInOrder)
+{
+    // Arrange
+    SetUpFile(kLines);
+    std::string content;
+
+    // Act
+    ip::ReadFileBlocks(
+        path_, [&content](std::string_view block) { content.append(block); },
+        Options());
+
+    // Assert
+    EXPECT_EQ(content, kLines);
+}
+
+TEST_P(AsyncReaderTest, ShouldReadLikeBufferReaderWhenLinesSpanBlocks)
+{
+    // Arrange
+    SetUpFile(kLines);
+
+    // Act
+    const auto ips = ip::ReadFirstIpFromFile(path_, Options());
+
+    // Assert
+    EXPECT_EQ(ips, ip::BufferReader{kLines}.ReadFirstIpFromLines());
+}
+
+TEST_P(AsyncReaderTest, ShouldReadNothingWhenFileIsEmpty)
+{
+    // Arrange
+    SetUpFile({});
+
+    // Act
+    const auto ips = ip::ReadFirstIpFromFile(path_, Options());
+
+    // Assert
+    EXPECT_TRUE(ips.empty());
+}
+
+TEST_P(AsyncReaderTest, ShouldStopAndRethrowWhenConsumerThrows)
+{
+    // Arrange
+    SetUpFile(kLines);
+    size_t blocks = 0;
+
+    // Act & Assert
+    EXPECT_THROW(ip::ReadFileBlocks(
+                     path_,
+                     [&blocks](std::string_view)
+                     {
+                         ++blocks;
+                         throw std::runtime_error("stop");
+                     },
+                     Options()),
+                 std::runtime_error);
+    EXPECT_EQ(blocks, 1U);
+}
+
+TEST_P(AsyncReaderTest, ShouldThrowWhenFileIsMissing)
+{
+    // Act & Assert
+    EXPECT_THROW(ip::ReadFirstIpFromFile(path_ + ".missing", Options()),
+                 std::system_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BackendsAndBlockSizes, AsyncReaderTest,
+    ::testing::Combine(::testing::Values(ip::ReadBackend::kIoUring,
+                                         ip::ReadBackend::kThread),
+                       ::testing::Values(size_t{1}, size_t{7}, size_t{4096})));
+
+TEST(AsyncReaderBackendTest, ShouldUseThreadBackendWhenRequested)
+{
+    // Arrange
+    ip::AsyncReadOptions options;
+    options.backend = ip::ReadBackend::kThread;
+
+    // Act
+    const auto backend =
+        ip::ReadFileBlocks("/dev/null", [](std::string_view) {}, options);
+
+    // Assert
+    EXPECT_EQ(backend, ip::ReadBackend::kThread);
+}
+
+TEST(AsyncReaderBackendTest, ShouldFallBackToThreadWhenFileIsNotRegular)
+{
+    // Act
+    const auto backend =
+        ip::ReadFileBlocks("/dev/null", [](std::string_view) {});
+
+    // Assert
+    EXPECT_EQ(backend, ip::ReadBackend::kThread);
+}
+
+}  // namespace
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace ip
+{
+
+// Blocking multi-producer multi-consumer queue holding at most `capacity`
+// items, used to connect pipeline stages with bounded memory.
+template <typename T>
+class BoundedQueue final
+{
+   public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_{std::max<size_t>(capacity, 1)}
+    {
+    }
+
+    // Blocks while the queue is full. Returns false, dropping the item, once
+    // the queue is closed.
+    bool Push(T item)
+    {
+        std::unique_lock lock{mutex_};
+
+        not_full_.wait(lock,
+                       [this] { return closed_ || items_.size() < capacity_; });
+
+        if (closed_)
+        {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+
+        return true;
+    }
+
+    // Blocks until an item is available. Returns std::nullopt once the queue
+    // is closed and drained.
+    std::optional<T> Pop()
+    {
+        std::unique_lock lock{mutex_};
+
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+
+        if (items_.empty())
+        {
+            return std::nullopt;
+        }
+
+        auto item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+
+        return item;
+    }
+
+    // Wakes up all waiters; queued items can still be popped.
+    void Close()
+    {
+        {
+            const std::lock_guard lock{mutex_};
+            closed_ = true;
+        }
+
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+   private:
+    const size_t capacity_;
+
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool closed_{false};
+};
+
+}  // namespace ip
@@ -0,0 +1,92 @@
+#include "bounded_queue.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using ip::BoundedQueue;
+
+TEST(BoundedQueueTest, ShouldPopItemsInPushOrder)
+{
+    // Arrange
+    BoundedQueue<int> queue{3};
+    queue.Push(1);
+    queue.Push(2);
+    queue.Push(3);
+
+    // Act
+    const auto first = queue.Pop();
+    const auto second = queue.Pop();
+    const auto third = queue.Pop();
+
+    // Assert
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 2);
+    EXPECT_EQ(third, 3);
+}
+
+TEST(BoundedQueueTest, ShouldDrainQueuedItemsWhenClosed)
+{
+    // Arrange
+    BoundedQueue<int> queue{2};
+    queue.Push(1);
+    queue.Close();
+
+    // Act
+    const auto item = queue.Pop();
+    const auto end = queue.Pop();
+
+    // Assert
+    EXPECT_EQ(item, 1);
+    EXPECT_EQ(end, std::nullopt);
+}
+
+TEST(BoundedQueueTest, ShouldRejectPushWhenClosed)
+{
+    // Arrange
+    BoundedQueue<int> queue{2};
+    queue.Close();
+
+    // Act
+    const auto pushed = queue.Push(1);
+
+    // Assert
+    EXPECT_FALSE(pushed);
+}
+
+TEST(BoundedQueueTest, ShouldPassEveryItemWhenProducerOutrunsCapacity)
+{
+    // Arrange
+    constexpr int kItems = 1000;
+    BoundedQueue<int> queue{1};
+    std::vector<int> consumed;
+
+    // Act
+    std::thread producer{[&queue]
+                         {
+                             for (int item = 0; item < kItems; ++item)
+                             {
+                                 queue.Push(item);
+                             }
+
+                             queue.Close();
+                         }};
+
+    while (const auto item = queue.Pop())
+    {
+        consumed.push_back(*item);
+    }
+
+    producer.join();
+
+    // Assert
+    ASSERT_EQ(consumed.size(), static_cast<size_t>(kItems));
+    EXPECT_TRUE(std::is_sorted(consumed.cbegin(), consumed.cend()));
+}
+
+}  // namespace
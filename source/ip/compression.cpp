@@ -0,0 +1,428 @@
+#include "compression.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef IP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef IP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "bounded_queue.hpp"
+#include "parallel.hpp"
+#include "utils.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr std::string_view kGzipMagic{"\x1f\x8b", 2};
+constexpr std::string_view kZstdMagic{"\x28\xb5\x2f\xfd", 4};
+
+// Hands decompressed text on to the consumer; returns false once it stopped.
+using Emit = std::function<bool(std::string)>;
+
+// Writes the decompressed text of one frame through emit() in blocks of at
+// most block_size bytes, none of them empty.
+using Decode = std::function<void(std::string_view frame, size_t block_size,
+                                  const Emit& emit)>;
+
+#ifdef IP_HAVE_ZLIB
+
+// Adding 16 to the window bits selects the gzip wrapper.
+constexpr int kGzipWindowBits = MAX_WBITS + 16;
+// zlib takes at most 4 GiB of input per call.
+constexpr size_t kMaxGzipInput = std::numeric_limits<uInt>::max();
+
+class Inflater final
+{
+   public:
+    Inflater()
+    {
+        if (inflateInit2(&stream_, kGzipWindowBits) != Z_OK)
+        {
+            throw std::runtime_error{"Failed to initialise zlib"};
+        }
+    }
+
+    Inflater(const Inflater&) = delete;
+    Inflater& operator=(const Inflater&) = delete;
+
+    ~Inflater() { inflateEnd(&stream_); }
+
+    z_stream& Stream() noexcept { return stream_; }
+
+   private:
+    z_stream stream_{};
+};
+
+// Decodes every member of the stream, as gzip -d does for concatenated files.
+void DecodeGzip(std::string_view data, size_t block_size, const Emit& emit)
+{
+    Inflater inflater;
+    auto& stream = inflater.Stream();
+
+    const auto refill = [&stream, &data]
+    {
+        const auto size = std::min(data.size(), kMaxGzipInput);
+
+        // zlib does not write through next_in.
+        stream.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(size);
+        data.remove_prefix(size);
+    };
+
+    refill();
+
+    for (bool finished = false; !finished;)
+    {
+        std::string block(block_size, '\0');
+
+        stream.next_out = reinterpret_cast<Bytef*>(block.data());
+        stream.avail_out = static_cast<uInt>(block.size());
+
+        while (stream.avail_out > 0)
+        {
+            if (stream.avail_in == 0)
+            {
+                refill();
+            }
+
+            const auto result = inflate(&stream, Z_NO_FLUSH);
+
+            if (result == Z_STREAM_END)
+            {
+                if (stream.avail_in == 0 && data.empty())
+                {
+                    finished = true;
+                    break;
+                }
+
+                inflateReset(&stream);
+            }
+            else if (result == Z_BUF_ERROR)
+            {
+                throw std::runtime_error{"Truncated gzip input"};
+            }
+            else if (result != Z_OK)
+            {
+                throw std::runtime_error{
+                    std::string{"Corrupt gzip input: "} +
+                    (stream.msg != nullptr ? stream.msg : "unknown error")};
+            }
+        }
+
+        block.resize(block.size() - stream.avail_out);
+
+        if (!block.empty() && !emit(std::move(block)))
+        {
+            return;
+        }
+    }
+}
+
+#endif
+
+#ifdef IP_HAVE_ZSTD
+
+struct DecompressionContextDeleter
+{
+    void operator()(ZSTD_DCtx* context) const noexcept
+    {
+        ZSTD_freeDCtx(context);
+    }
+};
+
+[[noreturn]] void ThrowZstdError(size_t code)
+{
+    throw std::runtime_error{std::string{"Corrupt zstd input: "} +
+                             ZSTD_getErrorName(code)};
+}
+
+// Independent frames decode in parallel. Only pzstd output and concatenated
+// .zst files have several; zstd -T writes a single frame even when it
+// compresses on several threads.
+std::vector<std::string_view> SplitZstdFrames(std::string_view data)
+{
+    std::vector<std::string_view> frames;
+
+    while (!data.empty())
+    {
+        const auto size =
+            ZSTD_findFrameCompressedSize(data.data(), data.size());
+
+        if (ZSTD_isError(size) != 0)
+        {
+            ThrowZstdError(size);
+        }
+
+        frames.push_back(data.substr(0, size));
+        data.remove_prefix(size);
+    }
+
+    return frames;
+}
+
+void DecodeZstd(std::string_view frame, size_t block_size, const Emit& emit)
+{
+    const std::unique_ptr<ZSTD_DCtx, DecompressionContextDeleter> context{
+        ZSTD_createDCtx()};
+
+    if (!context)
+    {
+        throw std::bad_alloc{};
+    }
+
+    ZSTD_inBuffer input{frame.data(), frame.size(), 0};
+
+    for (bool finished = false; !finished;)
+    {
+        std::string block(block_size, '\0');
+        ZSTD_outBuffer output{block.data(), block.size(), 0};
+
+        while (output.pos < output.size)
+        {
+            const auto hint =
+                ZSTD_decompressStream(context.get(), &output, &input);
+
+            if (ZSTD_isError(hint) != 0)
+            {
+                ThrowZstdError(hint);
+            }
+
+            if (hint == 0)
+            {
+                finished = true;
+                break;
+            }
+
+            if (input.pos == input.size && output.pos < output.size)
+            {
+                throw std::runtime_error{"Truncated zstd input"};
+            }
+        }
+
+        block.resize(output.pos);
+
+        if (!block.empty() && !emit(std::move(block)))
+        {
+            return;
+        }
+    }
+}
+
+#endif
+
+// Frame n is decoded by worker n % workers into its own queue, so every queue
+// holds its frames in order and the calling thread consumes them round-robin.
+// An empty block marks the end of a frame. Unused in builds without any
+// decompression library.
+[[maybe_unused]] void DecodeFrames(
+    const std::vector<std::string_view>& frames, const Decode& decode,
+    const BlockConsumer& consume, const DecompressOptions& options)
+{
+    const auto workers = std::clamp<size_t>(options.workers, 1,
+                                            std::max<size_t>(frames.size(), 1));
+    const auto block_size = std::max<size_t>(options.block_size, 1);
+    const auto queue_depth =
+        std::max<size_t>(options.queue_depth / workers, 1);
+
+    std::deque<BoundedQueue<std::string>> queues;
+
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        queues.emplace_back(queue_depth);
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    const auto close_all = [&queues]
+    {
+        for (auto& queue : queues)
+        {
+            queue.Close();
+        }
+    };
+
+    const auto decode_frames = [&](size_t worker)
+    {
+        auto& queue = queues[worker];
+        const Emit emit = [&queue](std::string block)
+        { return queue.Push(std::move(block)); };
+
+        try
+        {
+            for (auto frame = worker; frame < frames.size(); frame += workers)
+            {
+                decode(frames[frame], block_size, emit);
+
+                if (!queue.Push({}))
+                {
+                    break;
+                }
+            }
+
+            queue.Close();
+        }
+        catch (...)
+        {
+            const std::lock_guard lock{error_mutex};
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            close_all();
+        }
+    };
+
+    ThreadGroup threads;
+
+    try
+    {
+        for (size_t worker = 0; worker < workers; ++worker)
+        {
+            threads.Start([&decode_frames, worker] { decode_frames(worker); });
+        }
+
+        for (size_t frame = 0; frame < frames.size(); ++frame)
+        {
+            auto& queue = queues[frame % workers];
+            auto block = queue.Pop();
+
+            for (; block && !block->empty(); block = queue.Pop())
+            {
+                consume(*block);
+            }
+
+            // A worker failed and closed the queues.
+            if (!block)
+            {
+                break;
+            }
+        }
+    }
+    catch (...)
+    {
+        // Also reached when a worker cannot be started; the ones already
+        // running stop at the closed queues and are joined.
+        close_all();
+        threads.Join();
+        throw;
+    }
+
+    threads.Join();
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace
+
+Compression DetectCompression(std::string_view data) noexcept
+{
+    if (data.substr(0, kGzipMagic.size()) == kGzipMagic)
+    {
+        return Compression::kGzip;
+    }
+
+    if (data.substr(0, kZstdMagic.size()) == kZstdMagic)
+    {
+        return Compression::kZstd;
+    }
+
+    return Compression::kNone;
+}
+
+bool IsSupported(Compression compression) noexcept
+{
+    switch (compression)
+    {
+        case Compression::kNone:
+            return true;
+        case Compression::kGzip:
+#ifdef IP_HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::kZstd:
+#ifdef IP_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+
+    return false;
+}
+
+void DecompressBlocks(std::string_view data, const BlockConsumer& consume,
+                      [[maybe_unused]] const DecompressOptions& options)
+{
+    switch (DetectCompression(data))
+    {
+        case Compression::kNone:
+            if (!data.empty())
+            {
+                consume(data);
+            }
+
+            return;
+        case Compression::kGzip:
+#ifdef IP_HAVE_ZLIB
+            DecodeFrames({data}, DecodeGzip, consume, options);
+
+            return;
+#else
+            throw std::runtime_error{"gzip input needs a build with zlib"};
+#endif
+        case Compression::kZstd:
+#ifdef IP_HAVE_ZSTD
+            DecodeFrames(SplitZstdFrames(data), DecodeZstd, consume, options);
+
+            return;
+#else
+            throw std::runtime_error{"zstd input needs a build with libzstd"};
+#endif
+    }
+}
+
+IpList ReadFirstIpFromCompressed(std::string_view data,
+                                 const DecompressOptions& options)
+{
+    if (DetectCompression(data) == Compression::kNone)
+    {
+        return BufferReader{data, options.workers}.ReadFirstIpFromLines();
+    }
+
+    IncrementalReader reader;
+
+    DecompressBlocks(
+        data, [&reader](std::string_view block) { reader.Read(block); },
+        options);
+
+    return reader.Finish();
+}
+
+}  // namespace ip
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "async_reader.hpp"
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+enum class Compression
+{
+    kNone,
+    kGzip,
+    kZstd
+};
+
+// Recognises gzip and zstd data by their magic numbers.
+Compression DetectCompression(std::string_view data) noexcept;
+
+// Whether this build decompresses the format: gzip needs zlib and zstd needs
+// libzstd at build time.
+bool IsSupported(Compression compression) noexcept;
+
+struct DecompressOptions
+{
+    // Bytes of decompressed text handed to the consumer at once.
+    size_t block_size{size_t{1} << 20};
+    // Decompressed blocks buffered ahead of the consumer.
+    size_t queue_depth{4};
+    // Threads decoding the frames of zstd data concurrently. Only data of
+    // several frames, such as pzstd output, uses more than one: a single
+    // frame, as zstd -T writes, and a gzip stream are decoded by one thread.
+    size_t workers{1};
+};
+
+// Decompresses `data` on worker threads and calls consume() on the calling
+// thread with the decompressed text in order, so decompression and whatever
+// consume() does overlap, even when one thread does all the decoding. Data
+// that is not compressed is handed over as is. Throws std::runtime_error
+// when the data is corrupt or the format is not supported; an exception
+// thrown by consume() stops the workers and is rethrown.
+void DecompressBlocks(std::string_view data, const BlockConsumer& consume,
+                      const DecompressOptions& options = {});
+
+// Reads the first address of every line of the decompressed text like
+// BufferReader, parsing each block while the next ones are decompressed.
+IpList ReadFirstIpFromCompressed(std::string_view data,
+                                 const DecompressOptions& options = {});
+
+}  // namespace ip
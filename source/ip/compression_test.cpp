@@ -0,0 +1,270 @@
+#include "compression.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#ifdef IP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef IP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "utils.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+constexpr size_t kLines = 2000;
+constexpr size_t kLinesPerFrame = 300;
+
+// Every line starts with an address apart from every seventh one.
+std::string MakeLines(size_t first, size_t count)
+{
+    constexpr size_t kMalformedEvery = 7;
+    constexpr size_t kOctetValues = 256;
+
+    std::string text;
+
+    for (size_t line = first; line < first + count; ++line)
+    {
+        if (line % kMalformedEvery == 0)
+        {
+            text += "malformed\n";
+            continue;
+        }
+
+        text += "10." + std::to_string(line / kOctetValues) + "." +
+                std::to_string(line % kOctetValues) + ".1\t" +
+                std::to_string(line) + "\t0\n";
+    }
+
+    return text;
+}
+
+#ifdef IP_HAVE_ZLIB
+
+std::string Gzip(std::string_view text)
+{
+    // Adding 16 to the window bits selects the gzip wrapper.
+    constexpr int kGzipWindowBits = MAX_WBITS + 16;
+    constexpr int kMemoryLevel = 8;
+
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, kGzipWindowBits,
+                 kMemoryLevel, Z_DEFAULT_STRATEGY);
+
+    std::string compressed(deflateBound(&stream, text.size()), '\0');
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = static_cast<uInt>(text.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return compressed;
+}
+
+#endif
+
+#ifdef IP_HAVE_ZSTD
+
+std::string Zstd(std::string_view text)
+{
+    std::string compressed(ZSTD_compressBound(text.size()), '\0');
+
+    compressed.resize(ZSTD_compress(compressed.data(), compressed.size(),
+                                    text.data(), text.size(),
+                                    ZSTD_CLEVEL_DEFAULT));
+
+    return compressed;
+}
+
+// Independent frames of kLinesPerFrame lines, as zstd -T writes.
+std::string ZstdFrames(size_t lines)
+{
+    std::string compressed;
+
+    for (size_t first = 0; first < lines; first += kLinesPerFrame)
+    {
+        compressed +=
+            Zstd(MakeLines(first, std::min(kLinesPerFrame, lines - first)));
+    }
+
+    return compressed;
+}
+
+#endif
+
+TEST(CompressionTest, ShouldDetectFormatByMagicNumber)
+{
+    // Act & Assert
+    EXPECT_EQ(ip::DetectCompression("\x1f\x8b\x08"sv), ip::Compression::kGzip);
+    EXPECT_EQ(ip::DetectCompression("\x28\xb5\x2f\xfd\x00"sv),
+              ip::Compression::kZstd);
+    EXPECT_EQ(ip::DetectCompression("10.0.0.1\n"sv), ip::Compression::kNone);
+    EXPECT_EQ(ip::DetectCompression("\x1f"sv), ip::Compression::kNone);
+    EXPECT_EQ(ip::DetectCompression({}), ip::Compression::kNone);
+}
+
+TEST(CompressionTest, ShouldReadUncompressedDataLikeBufferReader)
+{
+    // Arrange
+    const auto text = MakeLines(0, kLines);
+
+    // Act
+    const auto ips = ip::ReadFirstIpFromCompressed(text);
+
+    // Assert
+    EXPECT_TRUE(ip::IsSupported(ip::Compression::kNone));
+    EXPECT_EQ(ips, ip::BufferReader{text}.ReadFirstIpFromLines());
+}
+
+class CompressionOptionsTest
+    : public ::testing::TestWithParam<std::tuple<size_t, size_t>>
+{
+   protected:
+    static ip::DecompressOptions Options()
+    {
+        ip::DecompressOptions options;
+        options.block_size = std::get<0>(GetParam());
+        options.workers = std::get<1>(GetParam());
+
+        return options;
+    }
+};
+
+#ifdef IP_HAVE_ZLIB
+
+TEST_P(CompressionOptionsTest, ShouldReadGzipLikeBufferReader)
+{
+    // Arrange
+    const auto text = MakeLines(0, kLines);
+
+    // Act
+    const auto ips = ip::ReadFirstIpFromCompressed(Gzip(text), Options());
+
+    // Assert
+    EXPECT_EQ(ips, ip::BufferReader{text}.ReadFirstIpFromLines());
+}
+
+TEST_P(CompressionOptionsTest, ShouldDecodeEveryMemberOfConcatenatedGzip)
+{
+    // Arrange
+    const auto first = MakeLines(0, kLinesPerFrame);
+    const auto second = MakeLines(kLinesPerFrame, kLinesPerFrame);
+    std::string text;
+
+    // Act
+    ip::DecompressBlocks(Gzip(first) + Gzip(second),
+                         [&text](std::string_view block) { text += block; },
+                         Options());
+
+    // Assert
+    EXPECT_EQ(text, first + second);
+}
+
+TEST(CompressionGzipTest, ShouldThrowWhenGzipIsTruncated)
+{
+    // Arrange
+    auto compressed = Gzip(MakeLines(0, kLines));
+    compressed.resize(compressed.size() / 2);
+
+    // Act & Assert
+    EXPECT_THROW(ip::ReadFirstIpFromCompressed(compressed), std::runtime_error);
+}
+
+TEST(CompressionGzipTest, ShouldStopAndRethrowWhenConsumerThrows)
+{
+    // Arrange
+    ip::DecompressOptions options;
+    options.block_size = 1;
+    size_t blocks = 0;
+
+    // Act & Assert
+    EXPECT_THROW(ip::DecompressBlocks(
+                     Gzip(MakeLines(0, kLines)),
+                     [&blocks](std::string_view)
+                     {
+                         ++blocks;
+                         throw std::invalid_argument("stop");
+                     },
+                     options),
+                 std::invalid_argument);
+    EXPECT_EQ(blocks, 1U);
+}
+
+#else
+
+TEST(CompressionGzipTest, ShouldThrowWhenBuiltWithoutZlib)
+{
+    // Act & Assert
+    EXPECT_FALSE(ip::IsSupported(ip::Compression::kGzip));
+    EXPECT_THROW(ip::ReadFirstIpFromCompressed("\x1f\x8b\x08"sv),
+                 std::runtime_error);
+}
+
+#endif
+
+#ifdef IP_HAVE_ZSTD
+
+TEST_P(CompressionOptionsTest, ShouldReadZstdFramesInOrder)
+{
+    // Arrange
+    const auto text = MakeLines(0, kLines);
+
+    // Act
+    const auto ips = ip::ReadFirstIpFromCompressed(ZstdFrames(kLines),
+                                                   Options());
+
+    // Assert
+    EXPECT_EQ(ips, ip::BufferReader{text}.ReadFirstIpFromLines());
+}
+
+TEST(CompressionZstdTest, ShouldThrowWhenZstdIsCorrupt)
+{
+    // Arrange
+    auto compressed = ZstdFrames(kLines);
+    compressed.resize(compressed.size() - 1);
+
+    ip::DecompressOptions options;
+    options.workers = 4;
+
+    // Act & Assert
+    EXPECT_THROW(ip::ReadFirstIpFromCompressed(compressed, options),
+                 std::runtime_error);
+}
+
+#else
+
+TEST(CompressionZstdTest, ShouldThrowWhenBuiltWithoutZstd)
+{
+    // Act & Assert
+    EXPECT_FALSE(ip::IsSupported(ip::Compression::kZstd));
+    EXPECT_THROW(ip::ReadFirstIpFromCompressed("\x28\xb5\x2f\xfd\x00"sv),
+                 std::runtime_error);
+}
+
+#endif
+
+INSTANTIATE_TEST_SUITE_P(BlockSizesAndWorkers, CompressionOptionsTest,
+                         ::testing::Combine(::testing::Values(size_t{1},
+                                                              size_t{7},
+                                                              size_t{4096}),
+                                            ::testing::Values(size_t{1},
+                                                              size_t{3})));
+
+// Builds without zlib and libzstd have no decompression tests to run.
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(CompressionOptionsTest);
+
+}  // namespace
@@ -0,0 +1,189 @@
+#include "distinct.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "lines.hpp"
+#include "parser.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr uint32_t kFibonacciMultiplier = 0x9E3779B9;
+constexpr unsigned kKeyBits = std::numeric_limits<uint32_t>::digits;
+constexpr unsigned kMinSlotBits = 4;
+// The table grows once it is half full, which keeps probe runs short.
+constexpr size_t kMaxLoadDivisor = 2;
+
+const char* ParseColumn(const char* first, const char* last,
+                        uint64_t& value) noexcept
+{
+    first = detail::SkipBlanks(first, last);
+
+    const auto [end, error] = std::from_chars(first, last, value);
+
+    if (error != std::errc{})
+    {
+        value = 0;
+
+        return first;
+    }
+
+    return end;
+}
+
+}  // namespace
+
+AddressIndexMap::AddressIndexMap(size_t expected_size)
+{
+    unsigned bits = kMinSlotBits;
+
+    while ((size_t{1} << bits) < expected_size * kMaxLoadDivisor)
+    {
+        ++bits;
+    }
+
+    slots_.resize(size_t{1} << bits);
+    shift_ = kKeyBits - bits;
+}
+
+std::pair<uint32_t, bool> AddressIndexMap::Insert(const IPv4& ip)
+{
+    if ((size_ + 1) * kMaxLoadDivisor > slots_.size())
+    {
+        Grow();
+    }
+
+    const auto key = ip.ToUint32();
+    const auto mask = slots_.size() - 1;
+
+    for (auto slot = SlotOf(key);; slot = (slot + 1) & mask)
+    {
+        if (slots_[slot].index == 0)
+        {
+            if (size_ >= std::numeric_limits<uint32_t>::max())
+            {
+                throw std::length_error{"Too many distinct addresses"};
+            }
+
+            slots_[slot] = {key, static_cast<uint32_t>(++size_)};
+
+            return {slots_[slot].index - 1, true};
+        }
+
+        if (slots_[slot].key == key)
+        {
+            return {slots_[slot].index - 1, false};
+        }
+    }
+}
+
+size_t AddressIndexMap::Size() const noexcept { return size_; }
+
+size_t AddressIndexMap::SlotOf(uint32_t key) const noexcept
+{
+    return static_cast<uint32_t>(key * kFibonacciMultiplier) >> shift_;
+}
+
+void AddressIndexMap::Grow()
+{
+    auto old_slots = std::move(slots_);
+
+    slots_.assign(old_slots.size() * 2, Slot{});
+    --shift_;
+
+    const auto mask = slots_.size() - 1;
+
+    for (const auto& old_slot : old_slots)
+    {
+        if (old_slot.index == 0)
+        {
+            continue;
+        }
+
+        auto slot = SlotOf(old_slot.key);
+
+        while (slots_[slot].index != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        slots_[slot] = old_slot;
+    }
+}
+
+void DeduplicateSorted(IpList& ips)
+{
+    ips.erase(std::unique(ips.begin(), ips.end()), ips.end());
+}
+
+void DeduplicateSorted(IPv6List& ips)
+{
+    ips.erase(std::unique(ips.begin(), ips.end()), ips.end());
+}
+
+void Deduplicate(IpList& ips)
+{
+    AddressIndexMap seen{ips.size()};
+
+    ips.erase(std::remove_if(ips.begin(), ips.end(),
+                             [&seen](const IPv4& ip)
+                             { return !seen.Insert(ip).second; }),
+              ips.end());
+}
+
+std::vector<AddressAggregate> AggregateColumns(std::string_view text)
+{
+    ColumnAggregator aggregator;
+    aggregator.Read(text);
+
+    return aggregator.Finish();
+}
+
+void ColumnAggregator::Read(std::string_view lines)
+{
+    detail::ForEachLine(
+        lines.data(), lines.data() + lines.size(),
+        [this](const char* line, const char* line_end)
+        {
+            IPv4 ip;
+
+            if (const auto* const columns = ParseIPv4(line, line_end, ip))
+            {
+                uint64_t second = 0;
+                uint64_t third = 0;
+
+                ParseColumn(ParseColumn(columns, line_end, second), line_end,
+                            third);
+
+                const auto [index, inserted] = indices_.Insert(ip);
+
+                if (inserted)
+                {
+                    aggregates_.push_back({ip, 0, 0, 0});
+                }
+
+                auto& aggregate = aggregates_[index];
+                ++aggregate.lines;
+                aggregate.second_column_sum += second;
+                aggregate.third_column_sum += third;
+            }
+        });
+}
+
+std::vector<AddressAggregate> ColumnAggregator::Finish()
+{
+    std::sort(aggregates_.begin(), aggregates_.end(),
+              [](const AddressAggregate& left, const AddressAggregate& right)
+              { return left.ip > right.ip; });
+
+    return std::move(aggregates_);
+}
+
+}  // namespace ip
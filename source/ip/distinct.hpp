@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ipv4.hpp"
+#include "ipv6.hpp"
+
+namespace ip
+{
+
+// Open-addressing hash map from an address to a dense index in insertion
+// order, keyed on the packed 32-bit value with Fibonacci hashing and linear
+// probing.
+class AddressIndexMap final
+{
+   public:
+    explicit AddressIndexMap(size_t expected_size = 0);
+
+    // Returns the index of the address and whether it was just inserted.
+    std::pair<uint32_t, bool> Insert(const IPv4& ip);
+
+    size_t Size() const noexcept;
+
+   private:
+    struct Slot
+    {
+        uint32_t key{0};
+        // Dense index + 1, 0 marking an empty slot, so that 0.0.0.0 is an
+        // ordinary key.
+        uint32_t index{0};
+    };
+
+    size_t SlotOf(uint32_t key) const noexcept;
+
+    void Grow();
+
+    std::vector<Slot> slots_;
+    unsigned shift_{0};
+    size_t size_{0};
+};
+
+// Removes repeated addresses from a list sorted by
+// SortReverseLexicographical in a single pass.
+void DeduplicateSorted(IpList& ips);
+
+void DeduplicateSorted(IPv6List& ips);
+
+// Removes repeated addresses from any list in O(n), keeping the first
+// occurrence of each in input order.
+void Deduplicate(IpList& ips);
+
+struct AddressAggregate
+{
+    IPv4 ip;
+    uint64_t lines{0};
+    uint64_t second_column_sum{0};
+    uint64_t third_column_sum{0};
+};
+
+// Reads ip_filter.tsv lines like BufferReader and sums the second and third
+// columns per address; missing or non-numeric columns count as 0. The result
+// is in SortReverseLexicographical order of the addresses.
+std::vector<AddressAggregate> AggregateColumns(std::string_view text);
+
+// AggregateColumns over text read in runs of whole lines, e.g. from a
+// LineBuffer.
+class ColumnAggregator final
+{
+   public:
+    void Read(std::string_view lines);
+
+    std::vector<AddressAggregate> Finish();
+
+   private:
+    AddressIndexMap indices_;
+    std::vector<AddressAggregate> aggregates_;
+};
+
+}  // namespace ip
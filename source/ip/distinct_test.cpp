@@ -0,0 +1,188 @@
+#include "distinct.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string_view>
+#include <unordered_set>
+
+#include "utils.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::AddressAggregate;
+using ip::AddressIndexMap;
+using ip::AggregateColumns;
+using ip::Deduplicate;
+using ip::DeduplicateSorted;
+using ip::IpList;
+using ip::IPv4;
+
+MATCHER_P4(IsAggregate, ip, lines, second_column_sum, third_column_sum, "")
+{
+    return arg.ip == ip && arg.lines == lines &&
+           arg.second_column_sum == second_column_sum &&
+           arg.third_column_sum == third_column_sum;
+}
+
+TEST(AddressIndexMapTest, ShouldAssignDenseIndicesInInsertionOrder)
+{
+    // Arrange
+    AddressIndexMap map;
+
+    // Act
+    const auto first = map.Insert(IPv4(10, 0, 0, 1));
+    const auto zero = map.Insert(IPv4(0, 0, 0, 0));
+    const auto again = map.Insert(IPv4(10, 0, 0, 1));
+
+    // Assert
+    EXPECT_EQ(first, std::make_pair(0U, true));
+    EXPECT_EQ(zero, std::make_pair(1U, true));
+    EXPECT_EQ(again, std::make_pair(0U, false));
+    EXPECT_EQ(map.Size(), 2);
+}
+
+TEST(AddressIndexMapTest, ShouldKeepIndicesWhenTableGrows)
+{
+    // Arrange
+    constexpr size_t kCount = 100000;
+    constexpr uint32_t kStride = 65537;
+
+    AddressIndexMap map;
+
+    for (uint32_t i = 0; i < kCount; ++i)
+    {
+        map.Insert(IPv4::FromUint32(i * kStride));
+    }
+
+    // Act & Assert
+    for (uint32_t i = 0; i < kCount; ++i)
+    {
+        EXPECT_EQ(map.Insert(IPv4::FromUint32(i * kStride)),
+                  std::make_pair(i, false));
+    }
+
+    EXPECT_EQ(map.Size(), kCount);
+}
+
+TEST(DeduplicateTest, ShouldKeepFirstOccurrencesInInputOrder)
+{
+    // Arrange
+    IpList ips{IPv4(1, 1, 1, 1), IPv4(2, 2, 2, 2), IPv4(1, 1, 1, 1),
+               IPv4(3, 3, 3, 3), IPv4(2, 2, 2, 2)};
+
+    // Act
+    Deduplicate(ips);
+
+    // Assert
+    EXPECT_THAT(ips, ::testing::ElementsAre(IPv4(1, 1, 1, 1), IPv4(2, 2, 2, 2),
+                                            IPv4(3, 3, 3, 3)));
+}
+
+TEST(DeduplicateTest, ShouldMatchSortedDeduplicationWhenListIsRandom)
+{
+    // Arrange
+    constexpr size_t kCount = 50000;
+    constexpr uint32_t kDistinct = 5000;
+    constexpr uint32_t kStride = 0x01010101;
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<uint32_t> distribution{0, kDistinct};
+
+    IpList ips(kCount);
+
+    for (auto& ip : ips)
+    {
+        ip = IPv4::FromUint32(distribution(generator) * kStride);
+    }
+
+    IpList sorted = ips;
+    ip::SortReverseLexicographical(sorted);
+
+    // Act
+    Deduplicate(ips);
+    DeduplicateSorted(sorted);
+
+    // Assert
+    ip::SortReverseLexicographical(ips);
+    EXPECT_EQ(ips, sorted);
+    EXPECT_EQ(std::unordered_set<IPv4>(sorted.begin(), sorted.end()).size(),
+              sorted.size());
+}
+
+TEST(AggregateColumnsTest, ShouldSumColumnsPerAddressInReverseOrder)
+{
+    // Arrange
+    constexpr auto kText =
+        "1.2.3.4\t5\t6\n"
+        "10.0.0.1\t1\t0\n"
+        "not an address\t7\t7\n"
+        "1.2.3.4\t2\t3\n"
+        "  10.0.0.1  4  x\n"
+        "8.8.8.8"sv;
+
+    // Act
+    const auto result = AggregateColumns(kText);
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(IsAggregate(IPv4(10, 0, 0, 1), 2U, 5U,
+                                                   0U),
+                                       IsAggregate(IPv4(8, 8, 8, 8), 1U, 0U,
+                                                   0U),
+                                       IsAggregate(IPv4(1, 2, 3, 4), 2U, 7U,
+                                                   9U)));
+}
+
+class ColumnAggregatorTest : public ::testing::TestWithParam<size_t>
+{
+};
+
+TEST_P(ColumnAggregatorTest, ShouldMatchAggregateColumnsForAnyBlockSize)
+{
+    // Arrange
+    constexpr auto kText =
+        "1.2.3.4\t5\t6\n"
+        "10.0.0.1\t1\t0\n"
+        "1.2.3.4\t2\t3\n"
+        "  10.0.0.1  4  x\n"
+        "1.2.3.4\t10"sv;
+    ip::ColumnAggregator aggregator;
+    ip::LineBuffer lines;
+    const auto read = [&aggregator](std::string_view text)
+    { aggregator.Read(text); };
+
+    // Act
+    for (size_t begin = 0; begin < kText.size(); begin += GetParam())
+    {
+        lines.Read(kText.substr(begin, GetParam()), read);
+    }
+
+    lines.Finish(read);
+    const auto result = aggregator.Finish();
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(IsAggregate(IPv4(10, 0, 0, 1), 2U, 5U,
+                                                   0U),
+                                       IsAggregate(IPv4(1, 2, 3, 4), 3U, 17U,
+                                                   9U)));
+}
+
+INSTANTIATE_TEST_SUITE_P(BlockSizes, ColumnAggregatorTest,
+                         ::testing::Values(1, 2, 5, 16, 1024));
+
+TEST(AggregateColumnsTest, ShouldReturnNothingWhenTextIsEmpty)
+{
+    // Act
+    const auto result = AggregateColumns(""sv);
+
+    // Assert
+    EXPECT_TRUE(result.empty());
+}
+
+}  // namespace
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <utility>
+
+namespace ip
+{
+
+// Owns a POSIX file descriptor and closes it on destruction; negative values
+// mean no descriptor.
+class FileDescriptor final
+{
+   public:
+    explicit FileDescriptor(int fd = -1) noexcept : fd_{fd} {}
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    FileDescriptor(FileDescriptor&& other) noexcept
+        : fd_{std::exchange(other.fd_, -1)}
+    {
+    }
+
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            fd_ = std::exchange(other.fd_, -1);
+        }
+
+        return *this;
+    }
+
+    ~FileDescriptor() { Close(); }
+
+    int Get() const noexcept { return fd_; }
+
+   private:
+    void Close() noexcept
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+
+    int fd_;
+};
+
+}  // namespace ip
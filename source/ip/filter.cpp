@@ -1,32 +1,153 @@
 #include "filter.hpp"
 
 #include <algorithm>
+#include <utility>
+
+#include "kernels.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
 
 namespace ip
 {
 
-Filter::Filter(const IpList& ips) : ips_(ips) {}
+namespace
+{
+
+constexpr size_t kMinIpsPerWorker = 16384;
+
+}  // namespace
+
+Filter::Filter(const IpList& ips, size_t workers)
+    : list_(&ips), workers_(std::max<size_t>(workers, 1))
+{
+}
+
+Filter::Filter(IpListView ips, size_t workers)
+    : view_(ips), workers_(std::max<size_t>(workers, 1))
+{
+}
 
 IpList Filter::FilterByMask(
     const std::array<std::optional<uint8_t>, 4>& mask) const
 {
-    return FilterImpl([&mask](const IPv4& ip) { return ip.Matches(mask); });
+    const Mask compiled{mask};
+
+    return Select([&compiled](const IPv4* first, const IPv4* last, IPv4* out)
+                  { return SelectByMask(first, last, compiled, out); });
 }
 
 IpList Filter::FilterByOctetValue(uint8_t octet_value) const
 {
-    return FilterImpl([octet_value](const IPv4& ip) noexcept
-                      { return ip.ContainsOctet(octet_value); });
+    return Select(
+        [octet_value](const IPv4* first, const IPv4* last, IPv4* out)
+        { return SelectByOctetValue(first, last, octet_value, out); });
+}
+
+IpListView Filter::FilterByMask(
+    const std::array<std::optional<uint8_t>, 4>& mask, IpArena& arena) const
+{
+    const Mask compiled{mask};
+
+    return Select([&compiled](const IPv4* first, const IPv4* last, IPv4* out)
+                  { return SelectByMask(first, last, compiled, out); },
+                  arena);
+}
+
+IpListView Filter::FilterByOctetValue(uint8_t octet_value,
+                                      IpArena& arena) const
+{
+    return Select(
+        [octet_value](const IPv4* first, const IPv4* last, IPv4* out)
+        { return SelectByOctetValue(first, last, octet_value, out); },
+        arena);
+}
+
+std::vector<IpList> Filter::FilterBatch(
+    const std::vector<Predicate>& predicates) const
+{
+    ScopedPhase phase{"filter"};
+    phase.AddRowsIn(Ips().size());
+
+    const auto count_rows_out = [&phase](const std::vector<IpList>& results)
+    {
+        for (const auto& result : results)
+        {
+            phase.AddRowsOut(result.size());
+        }
+    };
+
+    const auto workers = Workers();
+
+    std::vector<IpList> results(predicates.size());
+
+    if (workers <= 1)
+    {
+        FilterRange(predicates, 0, Ips().size(), results);
+        count_rows_out(results);
+
+        return results;
+    }
+
+    std::vector<std::vector<IpList>> partial_results(
+        workers, std::vector<IpList>(predicates.size()));
+
+    ForEachChunk(Ips().size(), workers,
+                 [this, &predicates, &partial_results](
+                     size_t chunk, size_t begin, size_t end)
+                 {
+                     FilterRange(predicates, begin, end,
+                                 partial_results[chunk]);
+                 });
+
+    for (size_t query = 0; query < predicates.size(); ++query)
+    {
+        std::vector<IpList> parts(workers);
+
+        for (size_t chunk = 0; chunk < workers; ++chunk)
+        {
+            parts[chunk] = std::move(partial_results[chunk][query]);
+        }
+
+        results[query] = Concatenate(parts);
+    }
+
+    count_rows_out(results);
+
+    return results;
+}
+
+Filter::Predicate Filter::ByMask(
+    const std::array<std::optional<uint8_t>, 4>& mask)
+{
+    return MaskPredicate{Mask{mask}};
 }
 
-IpList Filter::FilterImpl(const Predicate& predicate) const
+Filter::Predicate Filter::ByOctetValue(uint8_t octet_value)
 {
-    IpList result;
+    return OctetValuePredicate{octet_value};
+}
 
-    std::copy_if(ips_.begin(), ips_.end(), std::back_inserter(result),
-                 predicate);
+size_t Filter::Workers() const noexcept
+{
+    return std::min(workers_, Ips().size() / kMinIpsPerWorker);
+}
 
-    return result;
+void Filter::FilterRange(const std::vector<Predicate>& predicates,
+                         size_t begin, size_t end,
+                         std::vector<IpList>& results) const
+{
+    std::for_each(Ips().data() + begin, Ips().data() + end,
+                  [&predicates, &results](const IPv4& ip)
+                  {
+                      for (size_t query = 0; query < predicates.size();
+                           ++query)
+                      {
+                          if (predicates[query](ip))
+                          {
+                              results[query].emplace_back(ip);
+                          }
+                      }
+                  });
 }
 
 }  // namespace ip
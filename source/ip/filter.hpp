@@ -1,26 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <utility>
+#include <vector>
 
+#include "arena.hpp"
 #include "ipv4.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
 
 namespace ip
 {
 
+// Predicate objects for fixed rules. Unlike Filter::Predicate they are
+// concrete types, so FilterIf and the variadic FilterBatch inline them.
+class MaskPredicate final
+{
+   public:
+    constexpr explicit MaskPredicate(const Mask& mask) noexcept : mask_{mask}
+    {
+    }
+
+    constexpr bool operator()(const IPv4& ip) const noexcept
+    {
+        return ip.Matches(mask_);
+    }
+
+   private:
+    Mask mask_;
+};
+
+class OctetValuePredicate final
+{
+   public:
+    constexpr explicit OctetValuePredicate(uint8_t octet_value) noexcept
+        : octet_value_{octet_value}
+    {
+    }
+
+    constexpr bool operator()(const IPv4& ip) const noexcept
+    {
+        return ip.ContainsOctet(octet_value_);
+    }
+
+   private:
+    uint8_t octet_value_;
+};
+
 class Filter final
 {
    public:
     using Predicate = std::function<bool(const IPv4&)>;
 
-    explicit Filter(const IpList& ips);
+    // With more than one worker, lists long enough to be worth it are split
+    // into chunks filtered concurrently; the result keeps the input order.
+    // The list must outlive the filter, which reads it as it is at the time
+    // of each call.
+    explicit Filter(const IpList& ips, size_t workers = 1);
+
+    // Filters addresses the filter does not own, e.g. a mapped snapshot. They
+    // must stay in place and unchanged while the filter is used.
+    explicit Filter(IpListView ips, size_t workers = 1);
 
     IpList FilterByMask(
         const std::array<std::optional<uint8_t>, 4>& mask) const;
 
     IpList FilterByOctetValue(uint8_t octet_value) const;
 
+    // Filters with any callable taking const IPv4&, instantiated for its
+    // concrete type so the per-address call is inlined.
+    template <typename Accept>
+    IpList FilterIf(const Accept& accept) const;
+
+    // Arena-backed counterparts of the above: the result is written straight
+    // into room reserved for every address and trimmed afterwards, with no
+    // reallocation or intermediate copy.
+    IpListView FilterByMask(const std::array<std::optional<uint8_t>, 4>& mask,
+                            IpArena& arena) const;
+
+    IpListView FilterByOctetValue(uint8_t octet_value, IpArena& arena) const;
+
+    template <typename Accept>
+    IpListView FilterIf(const Accept& accept, IpArena& arena) const;
+
+    // Evaluates every predicate during a single pass over the addresses and
+    // returns one list per predicate, in the order they were given.
+    std::vector<IpList> FilterBatch(
+        const std::vector<Predicate>& predicates) const;
+
+    // Compile-time counterpart of the batch above for a fixed set of rules.
+    template <typename... Accepts>
+    std::array<IpList, sizeof...(Accepts)> FilterBatch(
+        const Accepts&... accepts) const;
+
+    static Predicate ByMask(const std::array<std::optional<uint8_t>, 4>& mask);
+
+    static Predicate ByOctetValue(uint8_t octet_value);
+
    private:
-    IpList FilterImpl(const Predicate& predicate) const;
+    // A selector copies the accepted addresses of [first, last) to an output
+    // with room for all of them and returns how many were copied, see
+    // kernels.hpp.
+    template <typename Selector>
+    IpList Select(const Selector& selector) const;
+
+    template <typename Selector>
+    IpListView Select(const Selector& selector, IpArena& arena) const;
+
+    size_t Workers() const noexcept;
 
-    const IpList& ips_;
+    void FilterRange(const std::vector<Predicate>& predicates, size_t begin,
+                     size_t end, std::vector<IpList>& results) const;
+
+    static constexpr size_t kSelectBlockSize = 1024;
+
+    // The addresses to filter: the list when there is one, else the view.
+    IpListView Ips() const noexcept
+    {
+        return list_ != nullptr ? IpListView{*list_} : view_;
+    }
+
+    const IpList* list_{nullptr};
+    IpListView view_;
+    size_t workers_;
 };
 
-}  // namespace ip
\ No newline at end of file
+namespace detail
+{
+
+template <typename Accept>
+auto MakeSelector(const Accept& accept)
+{
+    return [&accept](const IPv4* first, const IPv4* last, IPv4* out)
+    {
+        size_t count = 0;
+
+        // Unconditional stores keep the loop free of data-dependent
+        // branches.
+        for (; first != last; ++first)
+        {
+            out[count] = *first;
+            count += static_cast<size_t>(accept(*first));
+        }
+
+        return count;
+    };
+}
+
+}  // namespace detail
+
+template <typename Accept>
+IpList Filter::FilterIf(const Accept& accept) const
+{
+    return Select(detail::MakeSelector(accept));
+}
+
+template <typename Accept>
+IpListView Filter::FilterIf(const Accept& accept, IpArena& arena) const
+{
+    return Select(detail::MakeSelector(accept), arena);
+}
+
+template <typename... Accepts>
+std::array<IpList, sizeof...(Accepts)> Filter::FilterBatch(
+    const Accepts&... accepts) const
+{
+    using Results = std::array<IpList, sizeof...(Accepts)>;
+
+    ScopedPhase phase{"filter"};
+    phase.AddRowsIn(Ips().size());
+
+    const auto filter_range = [this, &accepts...](size_t begin, size_t end)
+    {
+        Results results;
+
+        std::for_each(Ips().data() + begin, Ips().data() + end,
+                      [&results, &accepts...](const IPv4& ip)
+                      {
+                          size_t query = 0;
+
+                          ((accepts(ip) ? results[query].push_back(ip)
+                                        : static_cast<void>(0),
+                            ++query),
+                           ...);
+                      });
+
+        return results;
+    };
+
+    const auto count_rows_out = [&phase](const Results& results)
+    {
+        for (const auto& result : results)
+        {
+            phase.AddRowsOut(result.size());
+        }
+    };
+
+    const auto workers = Workers();
+
+    if (workers <= 1)
+    {
+        auto results = filter_range(0, Ips().size());
+        count_rows_out(results);
+
+        return results;
+    }
+
+    std::vector<Results> partial_results(workers);
+
+    ForEachChunk(Ips().size(), workers,
+                 [&filter_range, &partial_results](size_t chunk, size_t begin,
+                                                   size_t end)
+                 { partial_results[chunk] = filter_range(begin, end); });
+
+    Results results;
+
+    for (size_t query = 0; query < results.size(); ++query)
+    {
+        std::vector<IpList> parts(workers);
+
+        for (size_t chunk = 0; chunk < workers; ++chunk)
+        {
+            parts[chunk] = std::move(partial_results[chunk][query]);
+        }
+
+        results[query] = Concatenate(parts);
+    }
+
+    count_rows_out(results);
+
+    return results;
+}
+
+template <typename Selector>
+IpList Filter::Select(const Selector& selector) const
+{
+    // The selector runs over fixed-size blocks into a scratch buffer, which
+    // bounds the extra memory of the vector stores regardless of list size.
+    const auto select_range = [&selector](const IPv4* first, const IPv4* last)
+    {
+        IpList result;
+        std::array<IPv4, kSelectBlockSize> block;
+
+        while (first != last)
+        {
+            const auto* const block_last =
+                first + std::min<size_t>(kSelectBlockSize,
+                                         static_cast<size_t>(last - first));
+            const auto count = selector(first, block_last, block.data());
+
+            result.insert(result.end(), block.cbegin(),
+                          block.cbegin() + count);
+            first = block_last;
+        }
+
+        return result;
+    };
+
+    ScopedPhase phase{"filter"};
+    phase.AddRowsIn(Ips().size());
+
+    const auto workers = Workers();
+
+    IpList result;
+
+    if (workers <= 1)
+    {
+        result = select_range(Ips().data(), Ips().data() + Ips().size());
+    }
+    else
+    {
+        std::vector<IpList> parts(workers);
+
+        ForEachChunk(Ips().size(), workers,
+                     [this, &select_range, &parts](size_t chunk, size_t begin,
+                                                   size_t end)
+                     {
+                         parts[chunk] = select_range(Ips().data() + begin,
+                                                     Ips().data() + end);
+                     });
+
+        result = Concatenate(parts);
+    }
+
+    phase.AddRowsOut(result.size());
+
+    return result;
+}
+
+template <typename Selector>
+IpListView Filter::Select(const Selector& selector, IpArena& arena) const
+{
+    ScopedPhase phase{"filter"};
+    phase.AddRowsIn(Ips().size());
+
+    IPv4* const out = arena.Allocate(Ips().size());
+    const auto workers = Workers();
+
+    size_t count = 0;
+
+    if (workers <= 1)
+    {
+        count = selector(Ips().data(), Ips().data() + Ips().size(), out);
+    }
+    else
+    {
+        // Every chunk selects into its own part of the output, then the
+        // parts are moved down to close the gaps, keeping the input order.
+        std::vector<size_t> begins(workers);
+        std::vector<size_t> counts(workers);
+
+        ForEachChunk(Ips().size(), workers,
+                     [this, &selector, &begins, &counts, out](
+                         size_t chunk, size_t begin, size_t end)
+                     {
+                         begins[chunk] = begin;
+                         counts[chunk] = selector(Ips().data() + begin,
+                                                  Ips().data() + end,
+                                                  out + begin);
+                     });
+
+        for (size_t chunk = 0; chunk < workers; ++chunk)
+        {
+            if (begins[chunk] != count)
+            {
+                std::copy(out + begins[chunk],
+                          out + begins[chunk] + counts[chunk], out + count);
+            }
+
+            count += counts[chunk];
+        }
+    }
+
+    arena.Shrink(out, count);
+    phase.AddRowsOut(count);
+
+    return {out, count};
+}
+
+}  // namespace ip
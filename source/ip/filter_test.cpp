@@ -162,4 +162,201 @@ TEST_F(FilterTest, ShouldReturnEmptyVectorWhenOctetValueIsNotFound)
     EXPECT_THAT(result, ::testing::IsEmpty());
 }
 
+TEST_F(FilterTest, ShouldReturnResultPerPredicateWhenBatchIsFiltered)
+{
+    // Arrange
+    SetUpFilter({IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1), IPv4(182, 16, 0, 1)});
+
+    // Act
+    auto result = filter->FilterBatch({ip::Filter::ByMask({192}),
+                                       ip::Filter::ByOctetValue(0),
+                                       ip::Filter::ByMask({1})});
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(
+                    ::testing::ElementsAre(IPv4(192, 168, 1, 1)),
+                    ::testing::ElementsAre(IPv4(10, 0, 0, 1),
+                                           IPv4(182, 16, 0, 1)),
+                    ::testing::IsEmpty()));
+}
+
+TEST_F(FilterTest, ShouldReturnNoResultsWhenBatchIsEmpty)
+{
+    // Arrange
+    SetUpFilter({IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1)});
+
+    // Act
+    auto result = filter->FilterBatch({});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::IsEmpty());
+}
+
+TEST_F(FilterTest, ShouldFilterWithCallableWhenLambdaIsGiven)
+{
+    // Arrange
+    SetUpFilter({IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1), IPv4(182, 16, 0, 1)});
+
+    // Act
+    auto result = filter->FilterIf([](const IPv4& ip)
+                                   { return ip.ToUint32() > 0xB0000000U; });
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(IPv4(192, 168, 1, 1),
+                                               IPv4(182, 16, 0, 1)));
+}
+
+TEST_F(FilterTest, ShouldReturnResultPerPredicateWhenFixedRulesAreBatched)
+{
+    // Arrange
+    constexpr ip::MaskPredicate kFirstOctetRule{ip::Mask{{192}}};
+    constexpr ip::OctetValuePredicate kAnyOctetRule{0};
+    SetUpFilter({IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1), IPv4(182, 16, 0, 1)});
+
+    // Act
+    auto result = filter->FilterBatch(kFirstOctetRule, kAnyOctetRule);
+
+    // Assert
+    EXPECT_THAT(result[0], ::testing::ElementsAre(IPv4(192, 168, 1, 1)));
+    EXPECT_THAT(result[1], ::testing::ElementsAre(IPv4(10, 0, 0, 1),
+                                                  IPv4(182, 16, 0, 1)));
+}
+
+TEST_F(FilterTest, ShouldWriteResultsToArenaWhenArenaIsGiven)
+{
+    // Arrange
+    SetUpFilter({IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1), IPv4(192, 0, 0, 1)});
+    ip::IpArena arena;
+
+    // Act
+    const auto by_mask = filter->FilterByMask({192}, arena);
+    const auto by_octet = filter->FilterByOctetValue(1, arena);
+
+    // Assert
+    EXPECT_EQ(IpList(by_mask.begin(), by_mask.end()),
+              IpList({IPv4(192, 168, 1, 1), IPv4(192, 0, 0, 1)}));
+    EXPECT_EQ(IpList(by_octet.begin(), by_octet.end()), ips);
+    EXPECT_EQ(by_octet.begin(), by_mask.end());
+}
+
+TEST_F(FilterTest, ShouldSeeAddedIpsWhenListGrowsAfterConstruction)
+{
+    // Arrange
+    SetUpFilter({IPv4(192, 168, 1, 1)});
+    ips.push_back(IPv4(192, 0, 0, 1));
+
+    // Act
+    auto result = filter->FilterByMask({192});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(IPv4(192, 168, 1, 1),
+                                               IPv4(192, 0, 0, 1)));
+}
+
+TEST(FilterViewTest, ShouldFilterViewedIpsWhenViewIsGiven)
+{
+    // Arrange
+    const IpList ips{IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1),
+                     IPv4(192, 0, 0, 1)};
+    const ip::Filter filter{ip::IpListView{ips.data() + 1, 2}};
+
+    // Act
+    auto result = filter.FilterByMask({192});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(IPv4(192, 0, 0, 1)));
+}
+
+class ParallelFilterTest : public ::testing::TestWithParam<size_t>
+{
+   protected:
+    static IpList MakeIps()
+    {
+        constexpr size_t kSize = 100000;
+
+        IpList ips;
+        ips.reserve(kSize);
+
+        for (size_t i = 0; i < kSize; ++i)
+        {
+            ips.emplace_back(static_cast<uint8_t>(i % 3 == 0 ? 46 : 1),
+                             static_cast<uint8_t>(i % 7 == 0 ? 70 : i),
+                             static_cast<uint8_t>(i >> 8U),
+                             static_cast<uint8_t>(i >> 16U));
+        }
+
+        return ips;
+    }
+};
+
+TEST_P(ParallelFilterTest, ShouldMatchSequentialFilterWhenWorkersAreUsed)
+{
+    // Arrange
+    const auto ips = MakeIps();
+    const ip::Filter sequential{ips};
+    const ip::Filter parallel{ips, GetParam()};
+
+    // Act, Assert
+    EXPECT_EQ(parallel.FilterByMask({46, 70}),
+              sequential.FilterByMask({46, 70}));
+    EXPECT_EQ(parallel.FilterByOctetValue(46),
+              sequential.FilterByOctetValue(46));
+    EXPECT_EQ(parallel.FilterByMask({}), ips);
+}
+
+TEST_P(ParallelFilterTest, ShouldMatchSequentialBatchWhenWorkersAreUsed)
+{
+    // Arrange
+    const auto ips = MakeIps();
+    const std::vector<ip::Filter::Predicate> predicates{
+        ip::Filter::ByMask({1}), ip::Filter::ByMask({46, 70}),
+        ip::Filter::ByOctetValue(46)};
+
+    // Act
+    const auto result = ip::Filter{ips, GetParam()}.FilterBatch(predicates);
+
+    // Assert
+    EXPECT_EQ(result, ip::Filter{ips}.FilterBatch(predicates));
+}
+
+TEST_P(ParallelFilterTest, ShouldMatchSequentialFilterWhenTemplatesAreUsed)
+{
+    // Arrange
+    const auto ips = MakeIps();
+    const ip::Filter sequential{ips};
+    const ip::Filter parallel{ips, GetParam()};
+    constexpr ip::MaskPredicate kRule{ip::Mask{{46, 70}}};
+
+    // Act
+    const auto result =
+        parallel.FilterBatch(kRule, ip::OctetValuePredicate{46});
+
+    // Assert
+    EXPECT_EQ(result[0], sequential.FilterByMask({46, 70}));
+    EXPECT_EQ(result[1], sequential.FilterByOctetValue(46));
+    EXPECT_EQ(parallel.FilterIf(kRule), sequential.FilterByMask({46, 70}));
+}
+
+TEST_P(ParallelFilterTest, ShouldMatchSequentialFilterWhenArenaIsUsed)
+{
+    // Arrange
+    const auto ips = MakeIps();
+    const ip::Filter parallel{ips, GetParam()};
+    ip::IpArena arena;
+
+    // Act
+    const auto by_mask = parallel.FilterByMask({46, 70}, arena);
+    const auto by_octet = parallel.FilterByOctetValue(46, arena);
+
+    // Assert
+    EXPECT_EQ(IpList(by_mask.begin(), by_mask.end()),
+              ip::Filter{ips}.FilterByMask({46, 70}));
+    EXPECT_EQ(IpList(by_octet.begin(), by_octet.end()),
+              ip::Filter{ips}.FilterByOctetValue(46));
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelFilterCases, ParallelFilterTest,
+                         ::testing::Values(2U, 3U, 8U, 64U));
+
 }  // namespace
\ No newline at end of file
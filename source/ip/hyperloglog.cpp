@@ -0,0 +1,129 @@
+#include "hyperloglog.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr unsigned kHashBits = std::numeric_limits<uint64_t>::digits;
+
+// splitmix64 finalizer: spreads the packed address over all 64 bits.
+constexpr uint64_t Mix(uint64_t value) noexcept
+{
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EB;
+    value ^= value >> 31;
+
+    return value;
+}
+
+// Bias correction constants of Flajolet et al.
+double Alpha(size_t registers) noexcept
+{
+    constexpr double kAlpha16 = 0.673;
+    constexpr double kAlpha32 = 0.697;
+    constexpr double kAlpha64 = 0.709;
+    constexpr double kAlphaNumerator = 0.7213;
+    constexpr double kAlphaDenominator = 1.079;
+
+    switch (registers)
+    {
+        case 16:
+            return kAlpha16;
+        case 32:
+            return kAlpha32;
+        case 64:
+            return kAlpha64;
+        default:
+            return kAlphaNumerator /
+                   (1.0 + kAlphaDenominator / static_cast<double>(registers));
+    }
+}
+
+}  // namespace
+
+HyperLogLog::HyperLogLog(unsigned precision) : precision_{precision}
+{
+    if (precision < kMinPrecision || precision > kMaxPrecision)
+    {
+        throw std::invalid_argument{"Invalid HyperLogLog precision: " +
+                                    std::to_string(precision)};
+    }
+
+    registers_.resize(size_t{1} << precision);
+}
+
+void HyperLogLog::Add(const IPv4& ip) noexcept
+{
+    const auto hash = Mix(ip.ToUint32());
+    const auto index = static_cast<size_t>(hash >> (kHashBits - precision_));
+    // A sentinel bit bounds the rank when the remaining bits are all zero.
+    const auto rest = (hash << precision_) | (uint64_t{1} << (precision_ - 1));
+    const auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+void HyperLogLog::Add(IpListView ips) noexcept
+{
+    for (const auto& ip : ips)
+    {
+        Add(ip);
+    }
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other)
+{
+    if (other.precision_ != precision_)
+    {
+        throw std::invalid_argument{
+            "Cannot merge HyperLogLog counters of different precision"};
+    }
+
+    std::transform(registers_.cbegin(), registers_.cend(),
+                   other.registers_.cbegin(), registers_.begin(),
+                   [](uint8_t left, uint8_t right)
+                   { return std::max(left, right); });
+}
+
+uint64_t HyperLogLog::Estimate() const noexcept
+{
+    const auto registers = static_cast<double>(registers_.size());
+
+    double inverse_sum = 0.0;
+    size_t zeros = 0;
+
+    for (const auto value : registers_)
+    {
+        inverse_sum += std::ldexp(1.0, -static_cast<int>(value));
+        zeros += static_cast<size_t>(value == 0);
+    }
+
+    const auto estimate =
+        Alpha(registers_.size()) * registers * registers / inverse_sum;
+
+    // Small cardinalities are counted more precisely from the empty
+    // registers (linear counting).
+    constexpr double kLinearCountingThreshold = 2.5;
+
+    if (estimate <= kLinearCountingThreshold * registers && zeros != 0)
+    {
+        return static_cast<uint64_t>(std::llround(
+            registers * std::log(registers / static_cast<double>(zeros))));
+    }
+
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+unsigned HyperLogLog::Precision() const noexcept { return precision_; }
+
+}  // namespace ip
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+// Approximate distinct counter for streams too large to deduplicate in
+// memory. Uses 2^precision one-byte registers; the standard error of the
+// estimate is about 1.04 / sqrt(2^precision), 0.8% with the default.
+class HyperLogLog final
+{
+   public:
+    static constexpr unsigned kMinPrecision = 4;
+    static constexpr unsigned kMaxPrecision = 18;
+    static constexpr unsigned kDefaultPrecision = 14;
+
+    // Throws std::invalid_argument when precision is outside
+    // [kMinPrecision, kMaxPrecision].
+    explicit HyperLogLog(unsigned precision = kDefaultPrecision);
+
+    void Add(const IPv4& ip) noexcept;
+
+    void Add(IpListView ips) noexcept;
+
+    // Folds in a counter of the same precision, e.g. one per worker. Throws
+    // std::invalid_argument when the precisions differ.
+    void Merge(const HyperLogLog& other);
+
+    uint64_t Estimate() const noexcept;
+
+    unsigned Precision() const noexcept;
+
+   private:
+    unsigned precision_;
+    std::vector<uint8_t> registers_;
+};
+
+}  // namespace ip
@@ -0,0 +1,91 @@
+#include "hyperloglog.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+
+using ip::HyperLogLog;
+using ip::IPv4;
+
+class HyperLogLogTest : public ::testing::TestWithParam<uint32_t>
+{
+   protected:
+    // Four standard errors of the default precision.
+    static constexpr double kTolerance = 4 * 1.04 / 128;
+};
+
+TEST_P(HyperLogLogTest, ShouldEstimateWithinToleranceWhenAddressesRepeat)
+{
+    // Arrange
+    constexpr uint32_t kRepeats = 3;
+    constexpr uint32_t kStride = 2654435761U;
+
+    const auto distinct = GetParam();
+    HyperLogLog counter;
+
+    // Act
+    for (uint32_t repeat = 0; repeat < kRepeats; ++repeat)
+    {
+        for (uint32_t i = 0; i < distinct; ++i)
+        {
+            counter.Add(IPv4::FromUint32(i * kStride));
+        }
+    }
+
+    // Assert
+    EXPECT_NEAR(static_cast<double>(counter.Estimate()), distinct,
+                std::max(1.0, kTolerance * distinct));
+}
+
+INSTANTIATE_TEST_SUITE_P(Cardinalities, HyperLogLogTest,
+                         ::testing::Values(0U, 1U, 100U, 10000U, 1000000U));
+
+TEST(HyperLogLogMergeTest, ShouldEstimateUnionWhenCountersAreMerged)
+{
+    // Arrange
+    constexpr uint32_t kCount = 100000;
+    constexpr uint32_t kOverlap = 50000;
+    constexpr double kTolerance = 0.05;
+
+    HyperLogLog left;
+    HyperLogLog right;
+
+    for (uint32_t i = 0; i < kCount; ++i)
+    {
+        left.Add(IPv4::FromUint32(i));
+        right.Add(IPv4::FromUint32(i + kCount - kOverlap));
+    }
+
+    // Act
+    left.Merge(right);
+
+    // Assert
+    constexpr double kUnion = 2 * kCount - kOverlap;
+    EXPECT_NEAR(static_cast<double>(left.Estimate()), kUnion,
+                kTolerance * kUnion);
+}
+
+TEST(HyperLogLogMergeTest, ShouldThrowWhenPrecisionsDiffer)
+{
+    // Arrange
+    HyperLogLog left{10};
+    const HyperLogLog right{12};
+
+    // Act & Assert
+    EXPECT_THROW(left.Merge(right), std::invalid_argument);
+}
+
+TEST(HyperLogLogConstructionTest, ShouldThrowWhenPrecisionIsOutOfRange)
+{
+    // Act & Assert
+    EXPECT_THROW(HyperLogLog{HyperLogLog::kMinPrecision - 1},
+                 std::invalid_argument);
+    EXPECT_THROW(HyperLogLog{HyperLogLog::kMaxPrecision + 1},
+                 std::invalid_argument);
+}
+
+}  // namespace
@@ -0,0 +1,405 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "async_reader.hpp"
+#include "filter.hpp"
+#include "ipv4.hpp"
+#include "query.hpp"
+#include "sorted_store.hpp"
+#include "utils.hpp"
+
+// Synthetic inputs range from kMinRows rows up to IP_BENCH_MAX_ROWS (1M by
+// default, 100M at most) in steps of ten, for every Distribution. Pick a
+// subset with --benchmark_filter, e.g. 'BM_Sort/rows:1000000/distribution:2'.
+namespace
+{
+
+constexpr int64_t kMinRows = 1000;
+constexpr int64_t kDefaultMaxRows = 1000000;
+constexpr int64_t kMaxRows = 100000000;
+constexpr int64_t kRowsMultiplier = 10;
+constexpr uint32_t kClusterCount = 16;
+
+enum class Distribution : int64_t
+{
+    // Every address equally likely.
+    kUniform,
+    // Addresses from a handful of /16 networks, like real access logs.
+    kClustered,
+    // Uniform addresses already in SortReverseLexicographical order.
+    kSorted
+};
+
+constexpr int64_t kDistributions = 3;
+
+struct Dataset
+{
+    int64_t rows{0};
+    Distribution distribution{Distribution::kUniform};
+    ip::IpList ips;
+    // The addresses as ip_filter.tsv lines.
+    std::string text;
+    // Length of the Printer output for ips.
+    size_t printed_bytes{0};
+};
+
+// Reads a string in place, unlike std::istringstream which copies it.
+class ViewBuffer final : public std::streambuf
+{
+   public:
+    explicit ViewBuffer(std::string_view text)
+    {
+        // The buffer is only read from.
+        char* const data = const_cast<char*>(text.data());
+        setg(data, data, data + text.size());
+    }
+};
+
+class NullBuffer final : public std::streambuf
+{
+   protected:
+    int_type overflow(int_type symbol) override { return symbol; }
+
+    std::streamsize xsputn(const char* /*data*/,
+                           std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+int64_t MaxRows()
+{
+    const char* const value = std::getenv("IP_BENCH_MAX_ROWS");
+
+    if (value == nullptr)
+    {
+        return kDefaultMaxRows;
+    }
+
+    return std::clamp<int64_t>(std::atoll(value), kMinRows, kMaxRows);
+}
+
+void RowsAndDistributions(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"rows", "distribution"});
+
+    for (int64_t rows = kMinRows; rows <= MaxRows(); rows *= kRowsMultiplier)
+    {
+        for (int64_t distribution = 0; distribution < kDistributions;
+             ++distribution)
+        {
+            bench->Args({rows, distribution});
+        }
+    }
+}
+
+ip::IPv4 RandomIp(std::mt19937& engine, Distribution distribution)
+{
+    const auto value = static_cast<uint32_t>(engine());
+
+    if (distribution != Distribution::kClustered)
+    {
+        return ip::IPv4::FromUint32(value);
+    }
+
+    constexpr uint32_t kHostBits = 16;
+    constexpr uint32_t kHostMask = (1U << kHostBits) - 1;
+    constexpr uint32_t kClusterStride = 7919;
+
+    const auto network = (value % kClusterCount) * kClusterStride;
+
+    return ip::IPv4::FromUint32((network << kHostBits) |
+                                ((value >> kHostBits) & kHostMask));
+}
+
+// Only the latest dataset is kept, so that the largest inputs fit in memory.
+const Dataset& GetDataset(const benchmark::State& state)
+{
+    static std::unique_ptr<Dataset> cached;
+
+    const auto rows = state.range(0);
+    const auto distribution = static_cast<Distribution>(state.range(1));
+
+    if (cached && cached->rows == rows && cached->distribution == distribution)
+    {
+        return *cached;
+    }
+
+    cached.reset();
+    cached = std::make_unique<Dataset>();
+    cached->rows = rows;
+    cached->distribution = distribution;
+
+    std::mt19937 engine{static_cast<uint32_t>(rows)};
+    cached->ips.reserve(static_cast<size_t>(rows));
+
+    for (int64_t row = 0; row < rows; ++row)
+    {
+        cached->ips.push_back(RandomIp(engine, distribution));
+    }
+
+    if (distribution == Distribution::kSorted)
+    {
+        ip::SortReverseLexicographical(cached->ips);
+    }
+
+    std::array<char, ip::kMaxIPv4Length> address{};
+
+    for (const auto& ip : cached->ips)
+    {
+        const auto* const end = ip::FormatIPv4(ip, address.data());
+        const auto length = static_cast<size_t>(end - address.data());
+
+        cached->text.append(address.data(), length);
+        cached->text.append("\t1\t0\n");
+        cached->printed_bytes += length + 1;
+    }
+
+    return *cached;
+}
+
+std::string ReadTestData()
+{
+    std::ifstream file{IP_TEST_DATA_DIR "/ip_filter.tsv", std::ios::binary};
+    std::ostringstream text;
+    text << file.rdbuf();
+
+    return text.str();
+}
+
+void SetProcessed(benchmark::State& state, size_t items, size_t bytes)
+{
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(items));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+
+void BM_ExtractOperator(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+
+    for (auto _ : state)
+    {
+        ViewBuffer buffer{data.text};
+        std::istream input{&buffer};
+        ip::IPv4 ip;
+
+        while (input >> ip)
+        {
+            benchmark::DoNotOptimize(ip);
+            input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+    }
+
+    SetProcessed(state, data.ips.size(), data.text.size());
+}
+
+void BM_ReadFirstIpFromLines(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+
+    for (auto _ : state)
+    {
+        ViewBuffer buffer{data.text};
+        std::istream input{&buffer};
+
+        benchmark::DoNotOptimize(ip::Reader{input}.ReadFirstIpFromLines());
+    }
+
+    SetProcessed(state, data.ips.size(), data.text.size());
+}
+
+void BM_BufferReader(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            ip::BufferReader{data.text}.ReadFirstIpFromLines());
+    }
+
+    SetProcessed(state, data.ips.size(), data.text.size());
+}
+
+void BM_BufferReaderParallel(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            ip::BufferReader{data.text, std::thread::hardware_concurrency()}
+                .ReadFirstIpFromLines());
+    }
+
+    SetProcessed(state, data.ips.size(), data.text.size());
+}
+
+// Reads a file from the page cache; the blocks are parsed while the next ones
+// are read.
+void BM_ReadFirstIpFromFile(benchmark::State& state, ip::ReadBackend backend)
+{
+    const auto& data = GetDataset(state);
+    const auto path = std::filesystem::temp_directory_path() /
+                      "ip_bench_read_first_ip_from_file.tsv";
+
+    std::ofstream{path, std::ios::binary} << data.text;
+
+    ip::AsyncReadOptions options;
+    options.backend = backend;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            ip::ReadFirstIpFromFile(path.string(), options));
+    }
+
+    std::filesystem::remove(path);
+    SetProcessed(state, data.ips.size(), data.text.size());
+}
+
+void BM_SortReverseLexicographical(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto ips = data.ips;
+        state.ResumeTiming();
+
+        ip::SortReverseLexicographical(ips);
+        benchmark::DoNotOptimize(ips.data());
+    }
+
+    SetProcessed(state, data.ips.size(), data.ips.size() * sizeof(ip::IPv4));
+}
+
+// Adds one buffer of addresses to the sorted dataset, the alternative to
+// re-sorting all of it as above.
+void BM_SortedStoreAppend(benchmark::State& state)
+{
+    constexpr size_t kBatchSize = ip::SortedStore::kDefaultBufferCapacity;
+
+    const auto& data = GetDataset(state);
+    auto sorted = data.ips;
+    ip::SortReverseLexicographical(sorted);
+
+    const ip::IpList batch(
+        data.ips.begin(),
+        data.ips.begin() + static_cast<std::ptrdiff_t>(
+                               std::min(kBatchSize, data.ips.size())));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ip::SortedStore store{sorted};
+        state.ResumeTiming();
+
+        store.Append(batch);
+        store.Flush();
+        benchmark::DoNotOptimize(store.View().Size());
+    }
+
+    SetProcessed(state, batch.size(), batch.size() * sizeof(ip::IPv4));
+}
+
+void BM_FilterByMask(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+    const ip::Filter filter{data.ips};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(filter.FilterByMask({46, 70}));
+    }
+
+    SetProcessed(state, data.ips.size(), data.ips.size() * sizeof(ip::IPv4));
+}
+
+void BM_FilterByOctetValue(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+    const ip::Filter filter{data.ips};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(filter.FilterByOctetValue(46));
+    }
+
+    SetProcessed(state, data.ips.size(), data.ips.size() * sizeof(ip::IPv4));
+}
+
+void BM_Print(benchmark::State& state)
+{
+    const auto& data = GetDataset(state);
+    NullBuffer buffer;
+    std::ostream output{&buffer};
+    ip::Printer printer{output};
+
+    for (auto _ : state)
+    {
+        printer.Print(data.ips);
+    }
+
+    SetProcessed(state, data.ips.size(), data.printed_bytes);
+}
+
+// The whole default ip_filter run over the repository's sample input.
+void BM_TestDataPipeline(benchmark::State& state)
+{
+    const auto text = ReadTestData();
+    NullBuffer buffer;
+    std::ostream output{&buffer};
+    ip::Printer printer{output};
+
+    size_t rows = 0;
+
+    for (auto _ : state)
+    {
+        auto ips = ip::BufferReader{text}.ReadFirstIpFromLines();
+        ip::SortReverseLexicographical(ips);
+
+        printer.Print(ips);
+        printer.Print(ip::Query::Parse("o1=1").Run(ips, true));
+        printer.Print(ip::Query::Parse("o1=46 and o2=70").Run(ips, true));
+        printer.Print(ip::Query::Parse("any=46").Run(ips, true));
+
+        rows = ips.size();
+    }
+
+    SetProcessed(state, rows, text.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ExtractOperator)->Apply(RowsAndDistributions);
+BENCHMARK(BM_ReadFirstIpFromLines)->Apply(RowsAndDistributions);
+BENCHMARK(BM_BufferReader)->Apply(RowsAndDistributions);
+BENCHMARK(BM_BufferReaderParallel)->Apply(RowsAndDistributions)->UseRealTime();
+BENCHMARK_CAPTURE(BM_ReadFirstIpFromFile, io_uring, ip::ReadBackend::kIoUring)
+    ->Apply(RowsAndDistributions);
+BENCHMARK_CAPTURE(BM_ReadFirstIpFromFile, thread, ip::ReadBackend::kThread)
+    ->Apply(RowsAndDistributions);
+BENCHMARK(BM_SortReverseLexicographical)->Apply(RowsAndDistributions);
+BENCHMARK(BM_SortedStoreAppend)->Apply(RowsAndDistributions);
+BENCHMARK(BM_FilterByMask)->Apply(RowsAndDistributions);
+BENCHMARK(BM_FilterByOctetValue)->Apply(RowsAndDistributions);
+BENCHMARK(BM_Print)->Apply(RowsAndDistributions);
+BENCHMARK(BM_TestDataPipeline);
@@ -1,22 +1,70 @@
 #include "ipv4.hpp"
 
-#include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <limits>
-#include <sstream>
+#include <ostream>
+#include <string>
 
 namespace ip
 {
 
-IPv4::IPv4(uint8_t first_octet, uint8_t second_octet, uint8_t third_octet,
-           uint8_t fourth_octet) noexcept
-    : octets_{first_octet, second_octet, third_octet, fourth_octet}
+using detail::kOctetMask;
+using detail::OctetShift;
+
+namespace
+{
+
+constexpr size_t kOctetValues = 256;
+constexpr size_t kMaxOctetDigits = 3;
+constexpr uint8_t kDecimalBase = 10;
+
+struct OctetText
+{
+    std::array<char, kMaxOctetDigits> digits;
+    size_t length;
+};
+
+// Decimal text of every octet value, so formatting needs no division.
+constexpr std::array<OctetText, kOctetValues> MakeOctetTexts() noexcept
+{
+    std::array<OctetText, kOctetValues> texts{};
+
+    for (size_t value = 0; value < kOctetValues; ++value)
+    {
+        auto& text = texts[value];
+        std::array<char, kMaxOctetDigits> reversed{};
+
+        for (auto rest = value; text.length == 0 || rest > 0;
+             rest /= kDecimalBase)
+        {
+            reversed[text.length++] =
+                static_cast<char>('0' + rest % kDecimalBase);
+        }
+
+        for (size_t i = 0; i < text.length; ++i)
+        {
+            text.digits[i] = reversed[text.length - 1 - i];
+        }
+    }
+
+    return texts;
+}
+
+constexpr auto kOctetTexts = MakeOctetTexts();
+
+}  // namespace
+
+IPv4 IPv4::FromUint32(uint32_t value) noexcept
 {
+    IPv4 ip;
+    ip.value_ = value;
+    return ip;
 }
 
 bool IPv4::operator==(const IPv4& other) const noexcept
 {
-    return octets_ == other.octets_;
+    return value_ == other.value_;
 }
 
 bool IPv4::operator!=(const IPv4& other) const noexcept
@@ -26,7 +74,7 @@ bool IPv4::operator!=(const IPv4& other) const noexcept
 
 bool IPv4::operator<(const IPv4& other) const noexcept
 {
-    return octets_ < other.octets_;
+    return value_ < other.value_;
 }
 
 bool IPv4::operator>(const IPv4& other) const noexcept { return other < *this; }
@@ -43,39 +91,47 @@ bool IPv4::operator>=(const IPv4& other) const noexcept
 
 IPv4::operator std::string() const
 {
-    std::ostringstream oss;
-    oss << static_cast<int>(octets_[0]) << '.' << static_cast<int>(octets_[1])
-        << '.' << static_cast<int>(octets_[2]) << '.'
-        << static_cast<int>(octets_[3]);
-    return oss.str();
+    std::array<char, kMaxIPv4Length> text{};
+
+    auto* end = FormatIPv4(*this, text.data());
+
+    return std::string(text.data(), end);
 }
 
 bool IPv4::Matches(
     const std::array<std::optional<uint8_t>, 4>& mask) const noexcept
 {
-    for (size_t i = 0; i < 4; ++i)
+    return Matches(Mask{mask});
+}
+
+char* FormatIPv4(const IPv4& ip, char* out) noexcept
+{
+    for (size_t octet = 0; octet < 4; ++octet)
     {
-        if (mask[i].has_value() && octets_[i] != mask[i].value())
+        if (octet > 0)
         {
-            return false;
+            *out++ = '.';
         }
-    }
 
-    return true;
-}
+        const auto& text =
+            kOctetTexts[(ip.ToUint32() >> OctetShift(octet)) & kOctetMask];
 
-bool IPv4::ContainsOctet(uint8_t octet_value) const noexcept
-{
-    return std::any_of(octets_.cbegin(), octets_.cend(),
-                       [octet_value](uint8_t octet) noexcept
-                       { return octet == octet_value; });
+        // Copying all three bytes stays within kMaxIPv4Length: the last
+        // octet never starts past offset 12.
+        std::memcpy(out, text.digits.data(), text.digits.size());
+        out += text.length;
+    }
+
+    return out;
 }
 
 }  // namespace ip
 
 std::ostream& operator<<(std::ostream& os, const ip::IPv4& ip)
 {
-    os << static_cast<std::string>(ip);
+    std::array<char, ip::kMaxIPv4Length> text{};
+
+    os.write(text.data(), ip::FormatIPv4(ip, text.data()) - text.data());
 
     return os;
 }
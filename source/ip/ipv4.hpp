@@ -1,19 +1,76 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
+#include <limits>
 #include <optional>
 #include <vector>
 
+#include "address_list.hpp"
+
 namespace ip
 {
 
+namespace detail
+{
+
+constexpr uint32_t kOctetBits = std::numeric_limits<uint8_t>::digits;
+constexpr uint32_t kOctetMask = std::numeric_limits<uint8_t>::max();
+
+// Bit offset of an octet in the packed address, 0 being the first octet.
+constexpr uint32_t OctetShift(size_t octet) noexcept
+{
+    constexpr size_t kLastOctet = 3;
+
+    return static_cast<uint32_t>(kLastOctet - octet) * kOctetBits;
+}
+
+}  // namespace detail
+
+// Octet mask compiled to a (value, bits) pair over the packed address: an
+// address matches when (address & Bits()) == Value(). Constant rules can be
+// built at compile time, e.g. constexpr Mask kRule{{46, 70}}.
+class Mask final
+{
+   public:
+    constexpr explicit Mask(
+        const std::array<std::optional<uint8_t>, 4>& octets) noexcept
+    {
+        for (size_t i = 0; i < octets.size(); ++i)
+        {
+            if (octets[i].has_value())
+            {
+                value_ |= static_cast<uint32_t>(*octets[i])
+                          << detail::OctetShift(i);
+                bits_ |= detail::kOctetMask << detail::OctetShift(i);
+            }
+        }
+    }
+
+    constexpr uint32_t Value() const noexcept { return value_; }
+    constexpr uint32_t Bits() const noexcept { return bits_; }
+
+   private:
+    uint32_t value_{0};
+    uint32_t bits_{0};
+};
+
 class IPv4 final
 {
    public:
-    IPv4(uint8_t first_octet = 0, uint8_t second_octet = 0,
-         uint8_t third_octet = 0, uint8_t fourth_octet = 0) noexcept;
+    constexpr IPv4(uint8_t first_octet = 0, uint8_t second_octet = 0,
+                   uint8_t third_octet = 0, uint8_t fourth_octet = 0) noexcept
+        : value_{static_cast<uint32_t>(first_octet) << detail::OctetShift(0) |
+                 static_cast<uint32_t>(second_octet) << detail::OctetShift(1) |
+                 static_cast<uint32_t>(third_octet) << detail::OctetShift(2) |
+                 static_cast<uint32_t>(fourth_octet) << detail::OctetShift(3)}
+    {
+    }
+
+    static IPv4 FromUint32(uint32_t value) noexcept;
 
     explicit operator std::string() const;
 
@@ -27,15 +84,56 @@ class IPv4 final
     bool Matches(
         const std::array<std::optional<uint8_t>, 4>& mask) const noexcept;
 
-    bool ContainsOctet(uint8_t octet_value) const noexcept;
+    constexpr bool Matches(const Mask& mask) const noexcept
+    {
+        return (value_ & mask.Bits()) == mask.Value();
+    }
+
+    constexpr bool ContainsOctet(uint8_t octet_value) const noexcept
+    {
+        // Zero bytes of the XOR mark equal octets; the classic SWAR test
+        // finds them without a branch per octet.
+        constexpr uint32_t kLowBits = 0x01010101;
+        constexpr uint32_t kHighBits = 0x80808080;
+
+        const uint32_t diff = value_ ^ (octet_value * kLowBits);
+
+        return ((diff - kLowBits) & ~diff & kHighBits) != 0;
+    }
+
+    // Big-endian packing: the first octet is the most significant byte, so
+    // integer order matches the lexicographical order of the octets.
+    constexpr uint32_t ToUint32() const noexcept { return value_; }
 
    private:
-    std::array<uint8_t, 4> octets_;
+    uint32_t value_;
 };
 
 using IpList = std::vector<IPv4>;
+using IpListView = AddressListView<IPv4>;
+
+// Length of the longest dotted-quad form, "255.255.255.255".
+constexpr size_t kMaxIPv4Length = 15;
+
+// Writes the dotted-quad form of the address to `out`, which must have room
+// for kMaxIPv4Length characters, and returns the end of the written text.
+char* FormatIPv4(const IPv4& ip, char* out) noexcept;
 
 }  // namespace ip
 
+namespace std
+{
+
+template <>
+struct hash<ip::IPv4>
+{
+    size_t operator()(const ip::IPv4& ip) const noexcept
+    {
+        return hash<uint32_t>{}(ip.ToUint32());
+    }
+};
+
+}  // namespace std
+
 std::ostream& operator<<(std::ostream& os, const ip::IPv4& ip);
 std::istream& operator>>(std::istream& is, ip::IPv4& ip);
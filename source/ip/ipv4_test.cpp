@@ -4,6 +4,7 @@
 
 #include <optional>
 #include <sstream>
+#include <unordered_set>
 #include <string_view>
 
 namespace
@@ -327,4 +328,138 @@ TEST(IPv4Test, ShouldReturnFalseWhenFourthOctetDoesNotMatch)
     EXPECT_FALSE(result);
 }
 
+TEST(IPv4Test, ShouldPackFirstOctetIntoMostSignificantByte)
+{
+    // Arrange
+    IPv4 ip(192, 168, 1, 2);
+
+    // Act
+    const auto result = ip.ToUint32();
+
+    // Assert
+    EXPECT_EQ(result, 0xC0A80102U);
+}
+
+TEST(IPv4Test, ShouldRoundTripWhenBuiltFromPackedValue)
+{
+    // Act
+    const auto ip = IPv4::FromUint32(0x2E460102U);
+
+    // Assert
+    EXPECT_EQ(ip, IPv4(46, 70, 1, 2));
+    EXPECT_EQ(ip.ToUint32(), 0x2E460102U);
+}
+
+TEST(IPv4Test, ShouldCompareAsPackedValueWhenOctetsDiffer)
+{
+    // Arrange
+    IPv4 ip1(1, 255, 255, 255);
+    IPv4 ip2(2, 0, 0, 0);
+
+    // Act, Assert
+    EXPECT_TRUE(ip1 < ip2);
+    EXPECT_TRUE(ip2 > ip1);
+}
+
+TEST(IPv4Test, ShouldHashEqualAddressesToSameBucket)
+{
+    // Arrange
+    std::unordered_set<IPv4> ips{IPv4(10, 0, 0, 1), IPv4(10, 0, 0, 1),
+                                 IPv4(10, 0, 0, 2)};
+
+    // Act, Assert
+    EXPECT_EQ(ips.size(), 2U);
+    EXPECT_EQ(ips.count(IPv4(10, 0, 0, 1)), 1U);
+}
+
+class IPv4ContainsOctetTest
+    : public ::testing::TestWithParam<std::tuple<IPv4, uint8_t, bool>>
+{
+};
+
+TEST_P(IPv4ContainsOctetTest, ShouldReportWhetherAnyOctetHasValue)
+{
+    // Arrange
+    const auto& [ip, octet_value, expected] = GetParam();
+
+    // Act
+    const auto result = ip.ContainsOctet(octet_value);
+
+    // Assert
+    EXPECT_EQ(result, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    IPv4ContainsOctetCases, IPv4ContainsOctetTest,
+    ::testing::Values(std::make_tuple(IPv4(46, 1, 2, 3), 46, true),
+                      std::make_tuple(IPv4(1, 2, 3, 46), 46, true),
+                      std::make_tuple(IPv4(1, 2, 3, 4), 46, false),
+                      std::make_tuple(IPv4(0, 1, 1, 1), 0, true),
+                      std::make_tuple(IPv4(1, 1, 1, 1), 0, false),
+                      std::make_tuple(IPv4(128, 129, 1, 255), 0, false),
+                      std::make_tuple(IPv4(255, 255, 255, 254), 255, true),
+                      std::make_tuple(IPv4(1, 0, 1, 1), 129, false)));
+
+TEST(MaskTest, ShouldCompileSetOctetsIntoValueAndBits)
+{
+    // Act
+    const ip::Mask mask{{46, std::nullopt, 1}};
+
+    // Assert
+    EXPECT_EQ(mask.Value(), 0x2E000100U);
+    EXPECT_EQ(mask.Bits(), 0xFF00FF00U);
+}
+
+TEST(MaskTest, ShouldBeBuiltAtCompileTimeWhenRuleIsConstant)
+{
+    // Arrange
+    constexpr ip::Mask kRule{{46, 70}};
+
+    // Act, Assert
+    static_assert(kRule.Value() == 0x2E460000U);
+    static_assert(kRule.Bits() == 0xFFFF0000U);
+    static_assert(IPv4(46, 70, 1, 1).Matches(kRule));
+    static_assert(!IPv4(46, 71, 1, 1).Matches(kRule));
+}
+
+TEST(MaskTest, ShouldMatchEverythingWhenNoOctetIsSet)
+{
+    // Arrange
+    const ip::Mask mask{{}};
+
+    // Act, Assert
+    EXPECT_TRUE(IPv4(0, 0, 0, 0).Matches(mask));
+    EXPECT_TRUE(IPv4(255, 255, 255, 255).Matches(mask));
+}
+
+TEST(MaskTest, ShouldMatchOnlyMaskedOctets)
+{
+    // Arrange
+    const ip::Mask mask{{std::nullopt, 70, std::nullopt, 1}};
+
+    // Act, Assert
+    EXPECT_TRUE(IPv4(46, 70, 9, 1).Matches(mask));
+    EXPECT_FALSE(IPv4(46, 70, 9, 2).Matches(mask));
+    EXPECT_FALSE(IPv4(46, 71, 9, 1).Matches(mask));
+}
+
+TEST(IPv4FormatTest, ShouldFormatEveryOctetValueLikeStdToString)
+{
+    for (int value = 0; value <= 255; ++value)
+    {
+        // Arrange
+        const auto octet = static_cast<uint8_t>(value);
+        const IPv4 ip(octet, 0, octet, octet);
+        std::array<char, ip::kMaxIPv4Length> text{};
+
+        // Act
+        auto* end = ip::FormatIPv4(ip, text.data());
+
+        // Assert
+        const auto digits = std::to_string(value);
+        EXPECT_EQ(std::string(text.data(), end),
+                  digits + ".0." + digits + '.' + digits);
+    }
+}
+
 }  // namespace
\ No newline at end of file
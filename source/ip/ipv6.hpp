@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "address_list.hpp"
+
+namespace ip
+{
+
+namespace detail
+{
+
+constexpr size_t kIPv6Groups = 8;
+constexpr size_t kGroupsPerWord = 4;
+constexpr uint32_t kGroupBits = std::numeric_limits<uint16_t>::digits;
+constexpr uint32_t kWordBits = std::numeric_limits<uint64_t>::digits;
+
+// Bit offset of a group within its 64-bit word, 0 being the first group.
+constexpr uint32_t GroupShift(size_t group) noexcept
+{
+    return static_cast<uint32_t>(kGroupsPerWord - 1 - group % kGroupsPerWord) *
+           kGroupBits;
+}
+
+}  // namespace detail
+
+// A 128-bit address kept as two big-endian 64-bit words, so that comparing
+// (High(), Low()) pairs orders addresses like their groups.
+class IPv6 final
+{
+   public:
+    constexpr IPv6() noexcept = default;
+
+    constexpr explicit IPv6(
+        const std::array<uint16_t, detail::kIPv6Groups>& groups) noexcept
+    {
+        for (size_t i = 0; i < groups.size(); ++i)
+        {
+            auto& word = i < detail::kGroupsPerWord ? high_ : low_;
+            word |= static_cast<uint64_t>(groups[i]) << detail::GroupShift(i);
+        }
+    }
+
+    static constexpr IPv6 FromWords(uint64_t high, uint64_t low) noexcept
+    {
+        IPv6 ip;
+        ip.high_ = high;
+        ip.low_ = low;
+        return ip;
+    }
+
+    explicit operator std::string() const;
+
+    constexpr bool operator==(const IPv6& other) const noexcept
+    {
+        return high_ == other.high_ && low_ == other.low_;
+    }
+
+    constexpr bool operator!=(const IPv6& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    constexpr bool operator<(const IPv6& other) const noexcept
+    {
+        return high_ < other.high_ ||
+               (high_ == other.high_ && low_ < other.low_);
+    }
+
+    constexpr bool operator>(const IPv6& other) const noexcept
+    {
+        return other < *this;
+    }
+
+    constexpr bool operator<=(const IPv6& other) const noexcept
+    {
+        return !(other < *this);
+    }
+
+    constexpr bool operator>=(const IPv6& other) const noexcept
+    {
+        return !(*this < other);
+    }
+
+    constexpr uint16_t Group(size_t group) const noexcept
+    {
+        const auto word = group < detail::kGroupsPerWord ? high_ : low_;
+
+        return static_cast<uint16_t>(word >> detail::GroupShift(group));
+    }
+
+    constexpr uint64_t High() const noexcept { return high_; }
+    constexpr uint64_t Low() const noexcept { return low_; }
+
+   private:
+    uint64_t high_{0};
+    uint64_t low_{0};
+};
+
+// CIDR prefix compiled to a (value, bits) pair per word, like Mask: an
+// address matches when both masked words equal the value, tested without a
+// branch between them.
+class IPv6Prefix final
+{
+   public:
+    static constexpr uint32_t kMaxLength = 2 * detail::kWordBits;
+
+    // Bits of `address` past `length` are ignored; lengths over kMaxLength
+    // are clamped.
+    constexpr IPv6Prefix(const IPv6& address, uint32_t length) noexcept
+        : high_bits_{WordBits(length)},
+          low_bits_{WordBits(length > detail::kWordBits
+                                 ? length - detail::kWordBits
+                                 : 0)},
+          high_value_{address.High() & high_bits_},
+          low_value_{address.Low() & low_bits_}
+    {
+    }
+
+    constexpr bool Matches(const IPv6& ip) const noexcept
+    {
+        return (((ip.High() & high_bits_) ^ high_value_) |
+                ((ip.Low() & low_bits_) ^ low_value_)) == 0;
+    }
+
+    // Lowest and highest addresses of the prefix.
+    constexpr IPv6 First() const noexcept
+    {
+        return IPv6::FromWords(high_value_, low_value_);
+    }
+
+    constexpr IPv6 Last() const noexcept
+    {
+        return IPv6::FromWords(high_value_ | ~high_bits_,
+                               low_value_ | ~low_bits_);
+    }
+
+   private:
+    static constexpr uint64_t WordBits(uint32_t length) noexcept
+    {
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        return length >= detail::kWordBits
+                   ? ~uint64_t{0}
+                   : ~uint64_t{0} << (detail::kWordBits - length);
+    }
+
+    uint64_t high_bits_;
+    uint64_t low_bits_;
+    uint64_t high_value_;
+    uint64_t low_value_;
+};
+
+using IPv6List = std::vector<IPv6>;
+using IPv6ListView = AddressListView<IPv6>;
+
+// Length of the longest RFC 5952 form,
+// "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff".
+constexpr size_t kMaxIPv6Length = 39;
+
+// Parses an address at the start of [first, last) in any RFC 4291 text form:
+// one "::" at most, 1 to 4 hex digits per group in either case, and an
+// optional dotted-quad tail for the last 32 bits. Returns a pointer past the
+// address, or nullptr when the input does not start with a valid address or
+// the address runs on into more hex digits, colons or dots.
+const char* ParseIPv6(const char* first, const char* last, IPv6& ip) noexcept;
+
+// Writes the RFC 5952 canonical form to `out`, which must have room for
+// kMaxIPv6Length characters, and returns the end of the written text:
+// lowercase, no leading zeros, the longest run of two or more zero groups
+// (the first one on ties) shortened to "::", and IPv4-mapped addresses as
+// "::ffff:a.b.c.d".
+char* FormatIPv6(const IPv6& ip, char* out) noexcept;
+
+// Parses "address/length" or a single address as a /128. Throws
+// std::invalid_argument on malformed input.
+IPv6Prefix ParseIPv6Prefix(std::string_view text);
+
+// Returns the addresses of `ips` within `prefix`, in list order. With more
+// than one worker, long lists are split into chunks filtered concurrently.
+IPv6List FilterByPrefix(IPv6ListView ips, const IPv6Prefix& prefix,
+                        size_t workers = 1);
+
+// Returns the slice of `ips`, sorted by SortReverseLexicographical, within
+// `prefix`; a prefix is one contiguous range, found by binary search.
+IPv6ListView FindPrefix(IPv6ListView ips, const IPv6Prefix& prefix) noexcept;
+
+}  // namespace ip
+
+namespace std
+{
+
+template <>
+struct hash<ip::IPv6>
+{
+    size_t operator()(const ip::IPv6& ip) const noexcept
+    {
+        constexpr uint64_t kGoldenRatio = 0x9E3779B97F4A7C15;
+
+        return hash<uint64_t>{}(ip.High() ^ (ip.Low() * kGoldenRatio));
+    }
+};
+
+}  // namespace std
+
+std::ostream& operator<<(std::ostream& os, const ip::IPv6& ip);
+std::istream& operator>>(std::istream& is, ip::IPv6& ip);
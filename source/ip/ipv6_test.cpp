@@ -0,0 +1,275 @@
+#include "ipv6.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::FilterByPrefix;
+using ip::FindPrefix;
+using ip::IPv6;
+using ip::IPv6List;
+using ip::ParseIPv6;
+using ip::ParseIPv6Prefix;
+
+const char* Parse(std::string_view text, IPv6& ip)
+{
+    return ParseIPv6(text.data(), text.data() + text.size(), ip);
+}
+
+class ParseIPv6Test
+    : public ::testing::TestWithParam<std::tuple<std::string_view, IPv6>>
+{
+};
+
+TEST_P(ParseIPv6Test, ShouldParseAddressWhenTextIsValid)
+{
+    // Arrange
+    const auto& [text, expected] = GetParam();
+    IPv6 ip;
+
+    // Act
+    const auto* const end = Parse(text, ip);
+
+    // Assert
+    EXPECT_EQ(end, text.data() + text.size());
+    EXPECT_EQ(ip, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Addresses, ParseIPv6Test,
+    ::testing::Values(
+        std::make_tuple("::"sv, IPv6{}),
+        std::make_tuple("::1"sv, IPv6({0, 0, 0, 0, 0, 0, 0, 1})),
+        std::make_tuple("1::"sv, IPv6({1, 0, 0, 0, 0, 0, 0, 0})),
+        std::make_tuple("2001:DB8::8:800:200C:417A"sv,
+                        IPv6({0x2001, 0xdb8, 0, 0, 0x8, 0x800, 0x200c,
+                              0x417a})),
+        std::make_tuple("2001:0db8:0000:0000:0000:ff00:0042:8329"sv,
+                        IPv6({0x2001, 0xdb8, 0, 0, 0, 0xff00, 0x42,
+                              0x8329})),
+        std::make_tuple("1:2:3:4:5:6:7::"sv, IPv6({1, 2, 3, 4, 5, 6, 7, 0})),
+        std::make_tuple("::ffff:192.0.2.128"sv,
+                        IPv6({0, 0, 0, 0, 0, 0xffff, 0xc000, 0x0280})),
+        std::make_tuple("1:2:3:4:5:6:1.2.3.4"sv,
+                        IPv6({1, 2, 3, 4, 5, 6, 0x0102, 0x0304}))));
+
+class ParseIPv6FailTest : public ::testing::TestWithParam<std::string_view>
+{
+};
+
+TEST_P(ParseIPv6FailTest, ShouldReturnNullWhenTextIsInvalid)
+{
+    // Arrange
+    IPv6 ip;
+
+    // Act
+    const auto* const end = Parse(GetParam(), ip);
+
+    // Assert
+    EXPECT_EQ(end, nullptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Addresses, ParseIPv6FailTest,
+    ::testing::Values(""sv, ":"sv, ":::"sv, "1:2"sv, "1::2::3"sv,
+                      "1:2:3:4:5:6:7:8:9"sv, "1:2:3:4:5:6:7:8::"sv,
+                      "12345::"sv, "1:"sv, ":1::"sv, "g::"sv, "1.2.3.4"sv,
+                      "::1.2.3"sv, "1:2:3:4:5:6:7:1.2.3.4"sv));
+
+TEST(ParseIPv6Test, ShouldStopAtBlankWhenLineHasMoreColumns)
+{
+    // Arrange
+    constexpr auto kLine = "fe80::1\t5\t6"sv;
+    IPv6 ip;
+
+    // Act
+    const auto* const end = Parse(kLine, ip);
+
+    // Assert
+    EXPECT_EQ(end, kLine.data() + kLine.find('\t'));
+    EXPECT_EQ(ip, IPv6({0xfe80, 0, 0, 0, 0, 0, 0, 1}));
+}
+
+class FormatIPv6Test
+    : public ::testing::TestWithParam<std::tuple<std::string_view, IPv6>>
+{
+};
+
+TEST_P(FormatIPv6Test, ShouldWriteCanonicalFormWhenAddressIsValid)
+{
+    // Arrange
+    const auto& [expected, ip] = GetParam();
+
+    // Act
+    const auto text = std::string{ip};
+
+    // Assert
+    EXPECT_EQ(text, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Addresses, FormatIPv6Test,
+    ::testing::Values(
+        std::make_tuple("::"sv, IPv6{}),
+        std::make_tuple("::1"sv, IPv6({0, 0, 0, 0, 0, 0, 0, 1})),
+        std::make_tuple("2001:db8::1"sv,
+                        IPv6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 1})),
+        std::make_tuple("2001:db8:0:1:1:1:1:1"sv,
+                        IPv6({0x2001, 0xdb8, 0, 1, 1, 1, 1, 1})),
+        std::make_tuple("2001:0:0:1::1"sv,
+                        IPv6({0x2001, 0, 0, 1, 0, 0, 0, 1})),
+        std::make_tuple("2001:db8::1:0:0:1"sv,
+                        IPv6({0x2001, 0xdb8, 0, 0, 1, 0, 0, 1})),
+        std::make_tuple("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"sv,
+                        IPv6({0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+                              0xffff, 0xffff})),
+        std::make_tuple("::ffff:192.0.2.128"sv,
+                        IPv6({0, 0, 0, 0, 0, 0xffff, 0xc000, 0x0280}))));
+
+TEST(IPv6Test, ShouldRoundTripThroughStreamOperators)
+{
+    // Arrange
+    std::stringstream stream{"  2001:DB8:0::42 rest"};
+    IPv6 ip;
+
+    // Act
+    stream >> ip;
+    std::ostringstream output;
+    output << ip;
+
+    // Assert
+    EXPECT_TRUE(stream);
+    EXPECT_EQ(output.str(), "2001:db8::42");
+}
+
+TEST(IPv6Test, ShouldSetFailBitWhenStreamHoldsIPv4)
+{
+    // Arrange
+    std::stringstream stream{"192.168.0.1"};
+    IPv6 ip;
+
+    // Act
+    stream >> ip;
+
+    // Assert
+    EXPECT_TRUE(stream.fail());
+}
+
+TEST(IPv6Test, ShouldOrderLikeGroups)
+{
+    // Arrange
+    const IPv6 low({0, 0, 0, 0, 0xffff, 0, 0, 0});
+    const IPv6 high({0, 0, 0, 1, 0, 0, 0, 0});
+
+    // Act & Assert
+    EXPECT_LT(low, high);
+    EXPECT_GT(high, low);
+    EXPECT_LE(low, low);
+    EXPECT_NE(low, high);
+}
+
+class IPv6PrefixTest
+    : public ::testing::TestWithParam<
+          std::tuple<std::string_view, std::string_view, bool>>
+{
+};
+
+TEST_P(IPv6PrefixTest, ShouldMatchAddressesWithinPrefix)
+{
+    // Arrange
+    const auto& [rule, address, expected] = GetParam();
+    IPv6 ip;
+    Parse(address, ip);
+
+    // Act
+    const auto matches = ParseIPv6Prefix(rule).Matches(ip);
+
+    // Assert
+    EXPECT_EQ(matches, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Prefixes, IPv6PrefixTest,
+    ::testing::Values(
+        std::make_tuple("2001:db8::/32"sv, "2001:db8:ffff::1"sv, true),
+        std::make_tuple("2001:db8::/32"sv, "2001:db9::"sv, false),
+        std::make_tuple("::/0"sv, "ffff::"sv, true),
+        std::make_tuple("2001:db8::1:0/112"sv, "2001:db8::1:ffff"sv, true),
+        std::make_tuple("2001:db8::1:0/112"sv, "2001:db8::2:0"sv, false),
+        std::make_tuple("2001:db8::/65"sv, "2001:db8::7fff:0:0:0"sv, true),
+        std::make_tuple("2001:db8::/65"sv, "2001:db8::8000:0:0:0"sv, false),
+        std::make_tuple(" fe80::1 "sv, "fe80::1"sv, true),
+        std::make_tuple("fe80::1/128"sv, "fe80::2"sv, false)));
+
+class IPv6PrefixFailTest : public ::testing::TestWithParam<std::string_view>
+{
+};
+
+TEST_P(IPv6PrefixFailTest, ShouldThrowWhenRuleIsInvalid)
+{
+    // Act & Assert
+    EXPECT_THROW(ParseIPv6Prefix(GetParam()), std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(Prefixes, IPv6PrefixFailTest,
+                         ::testing::Values(""sv, "2001:db8::/"sv,
+                                           "2001:db8::/129"sv,
+                                           "2001:db8::/-1"sv,
+                                           "2001:db8::/32x"sv, "10.0.0.0/8"sv));
+
+TEST(FilterByPrefixTest, ShouldKeepListOrderWhenFilteringInParallel)
+{
+    // Arrange
+    constexpr uint64_t kCount = 100000;
+    constexpr uint64_t kPrefixHigh = uint64_t{0x20010db8} << 32;
+    constexpr size_t kWorkers = 4;
+
+    IPv6List ips;
+    IPv6List expected;
+
+    for (uint64_t i = 0; i < kCount; ++i)
+    {
+        const auto ip = IPv6::FromWords(kPrefixHigh + i % 3, i);
+        ips.push_back(ip);
+
+        if (i % 3 == 0)
+        {
+            expected.push_back(ip);
+        }
+    }
+
+    // Act
+    const auto result =
+        FilterByPrefix(ips, ParseIPv6Prefix("2001:db8::/64"), kWorkers);
+
+    // Assert
+    EXPECT_EQ(result, expected);
+}
+
+TEST(FindPrefixTest, ShouldReturnSliceWhenListIsSortedDescending)
+{
+    // Arrange
+    const IPv6List ips{IPv6({0x2002, 0, 0, 0, 0, 0, 0, 0}),
+                       IPv6({0x2001, 0xdb8, 0xffff, 0, 0, 0, 0, 1}),
+                       IPv6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 1}),
+                       IPv6({0x2001, 0xdb7, 0, 0, 0, 0, 0, 0})};
+
+    // Act
+    const auto result = FindPrefix(ips, ParseIPv6Prefix("2001:db8::/32"));
+
+    // Assert
+    EXPECT_THAT(IPv6List(result.begin(), result.end()),
+                ::testing::ElementsAre(ips[1], ips[2]));
+}
+
+}  // namespace
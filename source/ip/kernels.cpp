@@ -0,0 +1,278 @@
+#include "kernels.hpp"
+
+#include <array>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IP_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ip
+{
+
+static_assert(sizeof(IPv4) == sizeof(uint32_t) &&
+                  std::is_standard_layout_v<IPv4>,
+              "Kernels load addresses as packed 32-bit lanes");
+
+namespace
+{
+
+template <typename Accept>
+size_t SelectScalar(const IPv4* first, const IPv4* last, IPv4* out,
+                    const Accept& accept) noexcept
+{
+    size_t count = 0;
+
+    for (; first != last; ++first)
+    {
+        out[count] = *first;
+        count += static_cast<size_t>(accept(*first));
+    }
+
+    return count;
+}
+
+#ifdef IP_KERNELS_X86
+
+constexpr size_t kAvx2Lanes = 8;
+constexpr size_t kAvx512Lanes = 16;
+constexpr uint32_t kLaneIndexBits = 4;
+constexpr uint32_t kLaneIndexMask = (1U << kLaneIndexBits) - 1;
+constexpr uint32_t kLaneMasks = 1U << kAvx2Lanes;
+constexpr uint32_t kLowBits = 0x01010101;
+constexpr uint32_t kHighBits = 0x80808080;
+// vpternlogd truth table of ~a & b & c.
+constexpr int kNotAAndBAndC = 0x08;
+
+// For every 8-bit match mask, the source lane of each output lane packed as
+// nibbles, used to left-pack matching addresses with vpermd.
+constexpr std::array<uint32_t, kLaneMasks> MakeLeftPackTable() noexcept
+{
+    std::array<uint32_t, kLaneMasks> table{};
+
+    for (uint32_t matches = 0; matches < kLaneMasks; ++matches)
+    {
+        uint32_t packed = 0;
+        uint32_t output_lane = 0;
+
+        for (uint32_t lane = 0; lane < kAvx2Lanes; ++lane)
+        {
+            if (((matches >> lane) & 1U) != 0)
+            {
+                packed |= lane << (output_lane * kLaneIndexBits);
+                ++output_lane;
+            }
+        }
+
+        table[matches] = packed;
+    }
+
+    return table;
+}
+
+constexpr auto kLeftPackTable = MakeLeftPackTable();
+
+__attribute__((target("avx2"))) IPv4* LeftPackAvx2(__m256i addresses,
+                                                   __m256i accepted,
+                                                   IPv4* out) noexcept
+{
+    const auto matches = static_cast<uint32_t>(
+        _mm256_movemask_ps(_mm256_castsi256_ps(accepted)));
+
+    const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    const __m256i lanes = _mm256_and_si256(
+        _mm256_srlv_epi32(
+            _mm256_set1_epi32(static_cast<int>(kLeftPackTable[matches])),
+            shifts),
+        _mm256_set1_epi32(static_cast<int>(kLaneIndexMask)));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                        _mm256_permutevar8x32_epi32(addresses, lanes));
+
+    return out + __builtin_popcount(matches);
+}
+
+__attribute__((target("avx2"))) size_t SelectByMaskAvx2(
+    const IPv4* first, const IPv4* last, const Mask& mask, IPv4* out) noexcept
+{
+    const __m256i bits = _mm256_set1_epi32(static_cast<int>(mask.Bits()));
+    const __m256i value = _mm256_set1_epi32(static_cast<int>(mask.Value()));
+
+    IPv4* const out_first = out;
+
+    for (; last - first >= static_cast<ptrdiff_t>(kAvx2Lanes);
+         first += kAvx2Lanes)
+    {
+        const __m256i addresses =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const __m256i accepted =
+            _mm256_cmpeq_epi32(_mm256_and_si256(addresses, bits), value);
+
+        out = LeftPackAvx2(addresses, accepted, out);
+    }
+
+    return static_cast<size_t>(out - out_first) +
+           SelectScalar(first, last, out,
+                        [&mask](const IPv4& ip) { return ip.Matches(mask); });
+}
+
+__attribute__((target("avx2"))) size_t SelectByOctetValueAvx2(
+    const IPv4* first, const IPv4* last, uint8_t octet_value,
+    IPv4* out) noexcept
+{
+    const __m256i octet = _mm256_set1_epi8(static_cast<char>(octet_value));
+    const __m256i zero = _mm256_setzero_si256();
+
+    IPv4* const out_first = out;
+
+    for (; last - first >= static_cast<ptrdiff_t>(kAvx2Lanes);
+         first += kAvx2Lanes)
+    {
+        const __m256i addresses =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        // A lane is accepted when any of its bytes equals the octet, i.e.
+        // when the byte comparison result is not zero for the lane.
+        const __m256i rejected =
+            _mm256_cmpeq_epi32(_mm256_cmpeq_epi8(addresses, octet), zero);
+        const __m256i accepted =
+            _mm256_xor_si256(rejected, _mm256_set1_epi32(-1));
+
+        out = LeftPackAvx2(addresses, accepted, out);
+    }
+
+    return static_cast<size_t>(out - out_first) +
+           SelectScalar(first, last, out,
+                        [octet_value](const IPv4& ip)
+                        { return ip.ContainsOctet(octet_value); });
+}
+
+__attribute__((target("avx512f"))) size_t SelectByMaskAvx512(
+    const IPv4* first, const IPv4* last, const Mask& mask, IPv4* out) noexcept
+{
+    const __m512i bits = _mm512_set1_epi32(static_cast<int>(mask.Bits()));
+    const __m512i value = _mm512_set1_epi32(static_cast<int>(mask.Value()));
+
+    IPv4* const out_first = out;
+
+    for (; last - first >= static_cast<ptrdiff_t>(kAvx512Lanes);
+         first += kAvx512Lanes)
+    {
+        const __m512i addresses = _mm512_loadu_si512(first);
+        const __mmask16 accepted =
+            _mm512_cmpeq_epi32_mask(_mm512_and_si512(addresses, bits), value);
+
+        _mm512_mask_compressstoreu_epi32(out, accepted, addresses);
+        out += __builtin_popcount(accepted);
+    }
+
+    return static_cast<size_t>(out - out_first) +
+           SelectScalar(first, last, out,
+                        [&mask](const IPv4& ip) { return ip.Matches(mask); });
+}
+
+__attribute__((target("avx512f"))) size_t SelectByOctetValueAvx512(
+    const IPv4* first, const IPv4* last, uint8_t octet_value,
+    IPv4* out) noexcept
+{
+    const __m512i octets =
+        _mm512_set1_epi32(static_cast<int>(octet_value * kLowBits));
+    const __m512i low_bits = _mm512_set1_epi32(static_cast<int>(kLowBits));
+    const __m512i high_bits = _mm512_set1_epi32(static_cast<int>(kHighBits));
+
+    IPv4* const out_first = out;
+
+    for (; last - first >= static_cast<ptrdiff_t>(kAvx512Lanes);
+         first += kAvx512Lanes)
+    {
+        const __m512i addresses = _mm512_loadu_si512(first);
+        // Same zero-byte test as IPv4::ContainsOctet, AVX-512F has no byte
+        // compares without the BW extension.
+        const __m512i diff = _mm512_xor_si512(addresses, octets);
+        const __m512i zero_bytes = _mm512_ternarylogic_epi32(
+            diff, _mm512_sub_epi32(diff, low_bits), high_bits,
+            kNotAAndBAndC);
+        const __mmask16 accepted =
+            _mm512_test_epi32_mask(zero_bytes, zero_bytes);
+
+        _mm512_mask_compressstoreu_epi32(out, accepted, addresses);
+        out += __builtin_popcount(accepted);
+    }
+
+    return static_cast<size_t>(out - out_first) +
+           SelectScalar(first, last, out,
+                        [octet_value](const IPv4& ip)
+                        { return ip.ContainsOctet(octet_value); });
+}
+
+#endif
+
+SimdLevel DetectSimdLevelOnce() noexcept
+{
+#ifdef IP_KERNELS_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") != 0)
+    {
+        return SimdLevel::kAvx512;
+    }
+
+    if (__builtin_cpu_supports("avx2") != 0)
+    {
+        return SimdLevel::kAvx2;
+    }
+#endif
+
+    return SimdLevel::kScalar;
+}
+
+}  // namespace
+
+SimdLevel DetectSimdLevel() noexcept
+{
+    static const SimdLevel level = DetectSimdLevelOnce();
+
+    return level;
+}
+
+size_t SelectByMask(const IPv4* first, const IPv4* last, const Mask& mask,
+                    IPv4* out, [[maybe_unused]] SimdLevel level) noexcept
+{
+#ifdef IP_KERNELS_X86
+    switch (level)
+    {
+        case SimdLevel::kAvx512:
+            return SelectByMaskAvx512(first, last, mask, out);
+        case SimdLevel::kAvx2:
+            return SelectByMaskAvx2(first, last, mask, out);
+        case SimdLevel::kScalar:
+            break;
+    }
+#endif
+
+    return SelectScalar(first, last, out,
+                        [&mask](const IPv4& ip) { return ip.Matches(mask); });
+}
+
+size_t SelectByOctetValue(const IPv4* first, const IPv4* last,
+                          uint8_t octet_value, IPv4* out,
+                          [[maybe_unused]] SimdLevel level) noexcept
+{
+#ifdef IP_KERNELS_X86
+    switch (level)
+    {
+        case SimdLevel::kAvx512:
+            return SelectByOctetValueAvx512(first, last, octet_value, out);
+        case SimdLevel::kAvx2:
+            return SelectByOctetValueAvx2(first, last, octet_value, out);
+        case SimdLevel::kScalar:
+            break;
+    }
+#endif
+
+    return SelectScalar(first, last, out,
+                        [octet_value](const IPv4& ip)
+                        { return ip.ContainsOctet(octet_value); });
+}
+
+}  // namespace ip
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+enum class SimdLevel
+{
+    kScalar,
+    kAvx2,
+    kAvx512
+};
+
+// Widest instruction set available on the running CPU, detected once.
+SimdLevel DetectSimdLevel() noexcept;
+
+// Copy the addresses of [first, last) accepted by the query to `out` in input
+// order and return how many were copied. `out` must have room for
+// last - first addresses: vector paths store whole registers and may write
+// past the returned count.
+size_t SelectByMask(const IPv4* first, const IPv4* last, const Mask& mask,
+                    IPv4* out, SimdLevel level = DetectSimdLevel()) noexcept;
+
+size_t SelectByOctetValue(const IPv4* first, const IPv4* last,
+                          uint8_t octet_value, IPv4* out,
+                          SimdLevel level = DetectSimdLevel()) noexcept;
+
+}  // namespace ip
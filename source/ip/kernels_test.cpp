@@ -0,0 +1,145 @@
+#include "kernels.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "ipv4.hpp"
+
+namespace
+{
+
+using ip::IpList;
+using ip::IPv4;
+using ip::SimdLevel;
+
+std::vector<SimdLevel> SupportedLevels()
+{
+    std::vector<SimdLevel> levels{SimdLevel::kScalar};
+
+    if (ip::DetectSimdLevel() >= SimdLevel::kAvx2)
+    {
+        levels.push_back(SimdLevel::kAvx2);
+    }
+
+    if (ip::DetectSimdLevel() >= SimdLevel::kAvx512)
+    {
+        levels.push_back(SimdLevel::kAvx512);
+    }
+
+    return levels;
+}
+
+IpList MakeIps(size_t size)
+{
+    std::mt19937 generator{42};
+    // Small octet ranges give both matching and rejected lanes in every
+    // vector.
+    std::uniform_int_distribution<int> octet{44, 47};
+
+    IpList ips;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        ips.emplace_back(static_cast<uint8_t>(octet(generator)),
+                         static_cast<uint8_t>(octet(generator) + 24),
+                         static_cast<uint8_t>(octet(generator)),
+                         static_cast<uint8_t>(i));
+    }
+
+    return ips;
+}
+
+template <typename Accept>
+IpList Expected(const IpList& ips, const Accept& accept)
+{
+    IpList result;
+
+    std::copy_if(ips.cbegin(), ips.cend(), std::back_inserter(result), accept);
+
+    return result;
+}
+
+class KernelsTest : public ::testing::TestWithParam<size_t>
+{
+};
+
+TEST_P(KernelsTest, ShouldSelectMatchingAddressesWhenMaskIsGiven)
+{
+    // Arrange
+    const auto ips = MakeIps(GetParam());
+    const ip::Mask mask{{46, 70}};
+
+    for (const auto level : SupportedLevels())
+    {
+        IpList out(ips.size());
+
+        // Act
+        const auto count = ip::SelectByMask(
+            ips.data(), ips.data() + ips.size(), mask, out.data(), level);
+        out.resize(count);
+
+        // Assert
+        EXPECT_EQ(out, Expected(ips, [&mask](const IPv4& ip)
+                                { return ip.Matches(mask); }))
+            << "SIMD level: " << static_cast<int>(level);
+    }
+}
+
+TEST_P(KernelsTest, ShouldSelectMatchingAddressesWhenOctetValueIsGiven)
+{
+    // Arrange
+    const auto ips = MakeIps(GetParam());
+
+    for (const auto level : SupportedLevels())
+    {
+        IpList out(ips.size());
+
+        // Act
+        const auto count = ip::SelectByOctetValue(
+            ips.data(), ips.data() + ips.size(), 46, out.data(), level);
+        out.resize(count);
+
+        // Assert
+        EXPECT_EQ(out, Expected(ips, [](const IPv4& ip)
+                                { return ip.ContainsOctet(46); }))
+            << "SIMD level: " << static_cast<int>(level);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(KernelsSizes, KernelsTest,
+                         ::testing::Values(0U, 1U, 7U, 8U, 15U, 16U, 17U, 33U,
+                                           1000U, 4099U));
+
+TEST(KernelsEdgeTest, ShouldSelectOctetZeroWithoutFalsePositives)
+{
+    // Arrange
+    const IpList ips{IPv4(128, 129, 1, 255), IPv4(1, 0, 1, 1),
+                     IPv4(255, 255, 255, 255), IPv4(1, 1, 1, 1),
+                     IPv4(0, 0, 0, 0),         IPv4(128, 128, 128, 128),
+                     IPv4(1, 1, 1, 0),         IPv4(2, 2, 2, 2),
+                     IPv4(1, 1, 1, 1),         IPv4(0, 255, 255, 255),
+                     IPv4(1, 1, 1, 1),         IPv4(1, 1, 1, 1),
+                     IPv4(1, 1, 1, 1),         IPv4(1, 1, 1, 1),
+                     IPv4(1, 1, 1, 1),         IPv4(1, 1, 1, 1)};
+
+    for (const auto level : SupportedLevels())
+    {
+        IpList out(ips.size());
+
+        // Act
+        const auto count = ip::SelectByOctetValue(
+            ips.data(), ips.data() + ips.size(), 0, out.data(), level);
+        out.resize(count);
+
+        // Assert
+        EXPECT_THAT(out, ::testing::ElementsAre(
+                             IPv4(1, 0, 1, 1), IPv4(0, 0, 0, 0),
+                             IPv4(1, 1, 1, 0), IPv4(0, 255, 255, 255)))
+            << "SIMD level: " << static_cast<int>(level);
+    }
+}
+
+}  // namespace
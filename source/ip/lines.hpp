@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cctype>
+#include <cstring>
+
+namespace ip
+{
+
+namespace detail
+{
+
+// Skips blanks up to the end of the line.
+inline const char* SkipBlanks(const char* first, const char* last) noexcept
+{
+    while (first != last && *first != '\n' &&
+           std::isspace(static_cast<unsigned char>(*first)))
+    {
+        ++first;
+    }
+
+    return first;
+}
+
+// Calls visit(text, line_end) for every line of [first, last), `text` being
+// the line past its leading blanks.
+template <typename Visit>
+void ForEachLine(const char* first, const char* last, const Visit& visit)
+{
+    while (first != last)
+    {
+        const auto* line_end = static_cast<const char*>(
+            std::memchr(first, '\n', static_cast<size_t>(last - first)));
+
+        if (line_end == nullptr)
+        {
+            line_end = last;
+        }
+
+        visit(SkipBlanks(first, line_end), line_end);
+
+        first = line_end == last ? last : line_end + 1;
+    }
+}
+
+}  // namespace detail
+
+}  // namespace ip
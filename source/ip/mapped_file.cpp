@@ -0,0 +1,97 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include "file_descriptor.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+[[noreturn]] void ThrowSystemError(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path)
+{
+    const FileDescriptor file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+
+    if (file.Get() < 0)
+    {
+        ThrowSystemError("Failed to open " + path);
+    }
+
+    struct stat file_stat{};
+
+    if (::fstat(file.Get(), &file_stat) != 0)
+    {
+        ThrowSystemError("Failed to stat " + path);
+    }
+
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    if (size_ == 0)
+    {
+        return;
+    }
+
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file.Get(), 0);
+
+    if (data_ == MAP_FAILED)
+    {
+        data_ = nullptr;
+        size_ = 0;
+        ThrowSystemError("Failed to map " + path);
+    }
+
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)},
+      size_{std::exchange(other.size_, 0)}
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+std::string_view MappedFile::View() const noexcept
+{
+    return {static_cast<const char*>(data_), size_};
+}
+
+void MappedFile::Unmap() noexcept
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+}  // namespace ip
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ip
+{
+
+class MappedFile final
+{
+   public:
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    ~MappedFile();
+
+    std::string_view View() const noexcept;
+
+   private:
+    void Unmap() noexcept;
+
+    void* data_{nullptr};
+    size_t size_{0};
+};
+
+}  // namespace ip
@@ -0,0 +1,73 @@
+#include "mapped_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+class MappedFileTest : public ::testing::Test
+{
+   protected:
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    void SetUpFile(std::string_view content)
+    {
+        std::ofstream file{path_, std::ios::binary};
+        file << content;
+    }
+
+    std::string path_{::testing::TempDir() + "mapped_file_test.tsv"};
+};
+
+TEST_F(MappedFileTest, ShouldExposeFileContentWhenFileExists)
+{
+    // Arrange
+    SetUpFile("192.168.1.1\t1\t0\n10.0.0.1\t2\t3\n"sv);
+
+    // Act
+    const ip::MappedFile file{path_};
+
+    // Assert
+    EXPECT_EQ(file.View(), "192.168.1.1\t1\t0\n10.0.0.1\t2\t3\n"sv);
+}
+
+TEST_F(MappedFileTest, ShouldExposeEmptyViewWhenFileIsEmpty)
+{
+    // Arrange
+    SetUpFile({});
+
+    // Act
+    const ip::MappedFile file{path_};
+
+    // Assert
+    EXPECT_TRUE(file.View().empty());
+}
+
+TEST_F(MappedFileTest, ShouldKeepContentWhenMoved)
+{
+    // Arrange
+    SetUpFile("10.0.0.1\n"sv);
+    ip::MappedFile file{path_};
+
+    // Act
+    const ip::MappedFile moved{std::move(file)};
+
+    // Assert
+    EXPECT_EQ(moved.View(), "10.0.0.1\n"sv);
+}
+
+TEST(MappedFileErrorTest, ShouldThrowWhenFileDoesNotExist)
+{
+    // Act, Assert
+    EXPECT_THROW(ip::MappedFile{"/nonexistent/ip_filter.tsv"},
+                 std::system_error);
+}
+
+}  // namespace
@@ -0,0 +1,150 @@
+#include "octet_index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr uint32_t kOctetBits = std::numeric_limits<uint8_t>::digits;
+
+uint8_t OctetOf(const IPv4& ip, size_t octet) noexcept
+{
+    constexpr size_t kLastOctet = 3;
+
+    return static_cast<uint8_t>(ip.ToUint32() >>
+                                ((kLastOctet - octet) * kOctetBits));
+}
+
+}  // namespace
+
+OctetIndex::OctetIndex(const IpList& ips) : ips_{ips}
+{
+    if (ips_.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::length_error("OctetIndex supports up to 2^32 addresses");
+    }
+
+    // Count first so every posting list is allocated exactly once.
+    std::array<std::array<size_t, kOctetValues>, kOctets> octet_counts{};
+    std::array<size_t, kOctetValues> any_counts{};
+
+    const auto for_each_octet = [this](auto&& visit)
+    {
+        for (size_t row = 0; row < ips_.size(); ++row)
+        {
+            std::array<uint8_t, kOctets> octets{};
+
+            for (size_t octet = 0; octet < kOctets; ++octet)
+            {
+                octets[octet] = OctetOf(ips_[row], octet);
+
+                const bool repeated =
+                    std::find(octets.cbegin(), octets.cbegin() + octet,
+                              octets[octet]) != octets.cbegin() + octet;
+
+                visit(static_cast<uint32_t>(row), octet, octets[octet],
+                      repeated);
+            }
+        }
+    };
+
+    for_each_octet(
+        [&octet_counts, &any_counts](uint32_t, size_t octet, uint8_t value,
+                                     bool repeated)
+        {
+            ++octet_counts[octet][value];
+
+            if (!repeated)
+            {
+                ++any_counts[value];
+            }
+        });
+
+    for (size_t value = 0; value < kOctetValues; ++value)
+    {
+        any_octet_[value].reserve(any_counts[value]);
+
+        for (size_t octet = 0; octet < kOctets; ++octet)
+        {
+            octet_at_[octet][value].reserve(octet_counts[octet][value]);
+        }
+    }
+
+    for_each_octet(
+        [this](uint32_t row, size_t octet, uint8_t value, bool repeated)
+        {
+            octet_at_[octet][value].push_back(row);
+
+            if (!repeated)
+            {
+                any_octet_[value].push_back(row);
+            }
+        });
+}
+
+const OctetIndex::Positions& OctetIndex::WithOctet(
+    uint8_t octet_value) const noexcept
+{
+    return any_octet_[octet_value];
+}
+
+const OctetIndex::Positions& OctetIndex::WithOctetAt(size_t octet,
+                                                     uint8_t octet_value) const
+{
+    return octet_at_.at(octet)[octet_value];
+}
+
+IpList OctetIndex::Collect(const Positions& positions) const
+{
+    IpList result;
+    result.reserve(positions.size());
+
+    std::transform(positions.cbegin(), positions.cend(),
+                   std::back_inserter(result),
+                   [this](uint32_t row) { return ips_[row]; });
+
+    return result;
+}
+
+IpListView OctetIndex::Collect(const Positions& positions,
+                               IpArena& arena) const
+{
+    IPv4* const out = arena.Allocate(positions.size());
+
+    std::transform(positions.cbegin(), positions.cend(), out,
+                   [this](uint32_t row) { return ips_[row]; });
+
+    return {out, positions.size()};
+}
+
+OctetIndex::Positions OctetIndex::Intersect(const Positions& lhs,
+                                            const Positions& rhs)
+{
+    Positions result;
+    result.reserve(std::min(lhs.size(), rhs.size()));
+
+    std::set_intersection(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(),
+                          std::back_inserter(result));
+
+    return result;
+}
+
+OctetIndex::Positions OctetIndex::Unite(const Positions& lhs,
+                                        const Positions& rhs)
+{
+    Positions result;
+    result.reserve(lhs.size() + rhs.size());
+
+    std::set_union(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(),
+                   std::back_inserter(result));
+
+    return result;
+}
+
+}  // namespace ip
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "arena.hpp"
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+// Posting lists of row positions for every octet value, so that octet
+// lookups over a fixed list become index reads and combined conditions
+// become sorted-list intersections and unions. The list must outlive the
+// index and stay unchanged.
+class OctetIndex final
+{
+   public:
+    using Positions = std::vector<uint32_t>;
+
+    explicit OctetIndex(const IpList& ips);
+
+    // Rows holding the value in any of their octets.
+    const Positions& WithOctet(uint8_t octet_value) const noexcept;
+
+    // Rows holding the value in the given octet, 0 being the first one.
+    const Positions& WithOctetAt(size_t octet, uint8_t octet_value) const;
+
+    IpList Collect(const Positions& positions) const;
+
+    // Same as above, writing the addresses to `arena`.
+    IpListView Collect(const Positions& positions, IpArena& arena) const;
+
+    static Positions Intersect(const Positions& lhs, const Positions& rhs);
+
+    static Positions Unite(const Positions& lhs, const Positions& rhs);
+
+   private:
+    static constexpr size_t kOctetValues = 256;
+    static constexpr size_t kOctets = 4;
+
+    using PostingLists = std::array<Positions, kOctetValues>;
+
+    const IpList& ips_;
+    PostingLists any_octet_;
+    std::array<PostingLists, kOctets> octet_at_;
+};
+
+}  // namespace ip
@@ -0,0 +1,92 @@
+#include "octet_index.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "filter.hpp"
+#include "ipv4.hpp"
+
+namespace
+{
+
+using ip::IpList;
+using ip::IPv4;
+using ip::OctetIndex;
+
+class OctetIndexTest : public ::testing::Test
+{
+   protected:
+    IpList ips{IPv4(46, 70, 1, 46), IPv4(1, 46, 0, 1), IPv4(1, 2, 3, 4),
+               IPv4(10, 0, 0, 46), IPv4(46, 1, 1, 1)};
+    OctetIndex index{ips};
+};
+
+TEST_F(OctetIndexTest, ShouldListEachRowOnceWhenValueIsInAnyOctet)
+{
+    // Act
+    const auto& result = index.WithOctet(46);
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(0U, 1U, 3U, 4U));
+}
+
+TEST_F(OctetIndexTest, ShouldListRowsWhenValueIsInGivenOctet)
+{
+    // Act
+    const auto& result = index.WithOctetAt(0, 1);
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(1U, 2U));
+}
+
+TEST_F(OctetIndexTest, ShouldThrowWhenOctetIsOutOfRange)
+{
+    // Act, Assert
+    EXPECT_THROW(static_cast<void>(index.WithOctetAt(4, 1)), std::out_of_range);
+}
+
+TEST_F(OctetIndexTest, ShouldCollectAddressesInRowOrder)
+{
+    // Act
+    const auto result = index.Collect(index.WithOctet(46));
+
+    // Assert
+    EXPECT_EQ(result, ip::Filter{ips}.FilterByOctetValue(46));
+}
+
+TEST_F(OctetIndexTest, ShouldIntersectWhenBothConditionsAreRequired)
+{
+    // Act
+    const auto result = index.Collect(
+        OctetIndex::Intersect(index.WithOctet(46), index.WithOctetAt(0, 1)));
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(IPv4(1, 46, 0, 1)));
+}
+
+TEST_F(OctetIndexTest, ShouldUniteWhenEitherConditionIsEnough)
+{
+    // Act
+    const auto result = index.Collect(
+        OctetIndex::Unite(index.WithOctetAt(3, 46), index.WithOctetAt(0, 1)));
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(IPv4(46, 70, 1, 46), IPv4(1, 46, 0, 1),
+                                       IPv4(1, 2, 3, 4), IPv4(10, 0, 0, 46)));
+}
+
+TEST(OctetIndexEmptyTest, ShouldReturnEmptyListsWhenListIsEmpty)
+{
+    // Arrange
+    const IpList ips;
+    const OctetIndex index{ips};
+
+    // Act, Assert
+    EXPECT_THAT(index.WithOctet(0), ::testing::IsEmpty());
+    EXPECT_THAT(index.WithOctetAt(3, 255), ::testing::IsEmpty());
+}
+
+}  // namespace
@@ -0,0 +1,152 @@
+#include "parallel.hpp"
+
+#include <system_error>
+#include <utility>
+
+namespace ip
+{
+
+WorkerPool& WorkerPool::Instance()
+{
+    static WorkerPool pool;
+
+    return pool;
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+
+    changed_.notify_all();
+
+    for (auto& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::Run(size_t count, const Task& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    Grow(count - 1);
+
+    Batch batch{count - 1};
+
+    {
+        const std::lock_guard lock{mutex_};
+
+        for (size_t index = 1; index < count; ++index)
+        {
+            jobs_.push_back({&task, index, &batch});
+        }
+    }
+
+    changed_.notify_all();
+    task(0);
+
+    std::unique_lock lock{mutex_};
+
+    while (batch.remaining > 0)
+    {
+        if (jobs_.empty())
+        {
+            changed_.wait(lock);
+            continue;
+        }
+
+        const auto job = jobs_.front();
+        jobs_.pop_front();
+
+        lock.unlock();
+        Execute(job);
+        lock.lock();
+    }
+}
+
+size_t WorkerPool::Threads() const
+{
+    const std::lock_guard lock{mutex_};
+
+    return threads_.size();
+}
+
+void WorkerPool::Grow(size_t count)
+{
+    const std::lock_guard lock{mutex_};
+
+    try
+    {
+        while (threads_.size() < count)
+        {
+            threads_.emplace_back([this] { Work(); });
+        }
+    }
+    catch (const std::system_error&)
+    {
+    }
+}
+
+void WorkerPool::Execute(const Job& job)
+{
+    (*job.task)(job.index);
+
+    bool completed = false;
+
+    {
+        const std::lock_guard lock{mutex_};
+        completed = --job.batch->remaining == 0;
+    }
+
+    if (completed)
+    {
+        changed_.notify_all();
+    }
+}
+
+void WorkerPool::Work()
+{
+    std::unique_lock lock{mutex_};
+
+    while (true)
+    {
+        changed_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+
+        if (stopping_)
+        {
+            return;
+        }
+
+        const auto job = jobs_.front();
+        jobs_.pop_front();
+
+        lock.unlock();
+        Execute(job);
+        lock.lock();
+    }
+}
+
+ThreadGroup::~ThreadGroup() { Join(); }
+
+void ThreadGroup::Start(std::function<void()> run)
+{
+    threads_.emplace_back(std::move(run));
+}
+
+void ThreadGroup::Join()
+{
+    for (auto& thread : threads_)
+    {
+        thread.join();
+    }
+
+    threads_.clear();
+}
+
+}  // namespace ip
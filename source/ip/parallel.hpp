@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ip
+{
+
+// Process-wide threads running the chunks of ForEachChunk, so parallel calls
+// do not pay for creating and joining threads. The pool grows to the largest
+// number of tasks run at once and its threads live until exit. It is meant
+// for short fork-join chunks; work that runs for long belongs on a
+// ThreadGroup.
+class WorkerPool final
+{
+   public:
+    using Task = std::function<void(size_t)>;
+
+    static WorkerPool& Instance();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool();
+
+    // Calls task(index) for every index in [0, count), index 0 on the calling
+    // thread and the others on pool threads, and returns once all are done.
+    // While waiting, the calling thread runs queued tasks itself, so tasks may
+    // call Run in turn. `task` must not throw.
+    void Run(size_t count, const Task& task);
+
+    size_t Threads() const;
+
+   private:
+    struct Batch
+    {
+        size_t remaining{0};
+    };
+
+    struct Job
+    {
+        const Task* task{nullptr};
+        size_t index{0};
+        Batch* batch{nullptr};
+    };
+
+    WorkerPool() = default;
+
+    // Starts threads up to `count`; a thread that cannot be started leaves
+    // its share of the work to the others.
+    void Grow(size_t count);
+
+    void Execute(const Job& job);
+
+    void Work();
+
+    mutable std::mutex mutex_;
+    // Signalled when a job is queued, a batch completes or the pool stops.
+    std::condition_variable changed_;
+    std::deque<Job> jobs_;
+    std::vector<std::thread> threads_;
+    bool stopping_{false};
+};
+
+// Dedicated threads for long-running or blocking work, which would otherwise
+// hold WorkerPool threads that fork-join chunks are waiting for. The threads
+// are joined on destruction, so an exception thrown while some are running
+// never destroys a joinable std::thread.
+class ThreadGroup final
+{
+   public:
+    ThreadGroup() = default;
+
+    ThreadGroup(const ThreadGroup&) = delete;
+    ThreadGroup& operator=(const ThreadGroup&) = delete;
+
+    ~ThreadGroup();
+
+    // Throws std::system_error when the thread cannot be started.
+    void Start(std::function<void()> run);
+
+    void Join();
+
+   private:
+    std::vector<std::thread> threads_;
+};
+
+// Splits [0, count) into at most `workers` contiguous chunks of nearly equal
+// size and calls task(chunk, begin, end) for each of them. The first chunk
+// runs on the calling thread, the others on WorkerPool threads. The first
+// exception thrown by a task is rethrown once all chunks are done.
+template <typename Task>
+void ForEachChunk(size_t count, size_t workers, const Task& task)
+{
+    workers = std::clamp<size_t>(workers, 1, std::max<size_t>(count, 1));
+
+    std::vector<std::exception_ptr> errors(workers);
+
+    const WorkerPool::Task run_chunk = [&](size_t chunk) noexcept
+    {
+        try
+        {
+            task(chunk, count * chunk / workers, count * (chunk + 1) / workers);
+        }
+        catch (...)
+        {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    if (workers == 1)
+    {
+        run_chunk(0);
+    }
+    else
+    {
+        WorkerPool::Instance().Run(workers, run_chunk);
+    }
+
+    for (const auto& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Joins per-chunk results back to back, so the result keeps their order.
+// Parts are copied concurrently to their prefix-sum offsets.
+template <typename T>
+std::vector<T> Concatenate(const std::vector<std::vector<T>>& parts)
+{
+    if (parts.empty())
+    {
+        return {};
+    }
+
+    std::vector<size_t> offsets(parts.size() + 1);
+
+    for (size_t part = 0; part < parts.size(); ++part)
+    {
+        offsets[part + 1] = offsets[part] + parts[part].size();
+    }
+
+    std::vector<T> result(offsets.back());
+
+    ForEachChunk(parts.size(), parts.size(),
+                 [&result, &parts, &offsets](size_t part,
+                                             [[maybe_unused]] size_t begin,
+                                             [[maybe_unused]] size_t end)
+                 {
+                     std::copy(parts[part].cbegin(), parts[part].cend(),
+                               result.data() + offsets[part]);
+                 });
+
+    return result;
+}
+
+// Same as above, but a single part is moved out instead of copied.
+template <typename T>
+std::vector<T> Concatenate(std::vector<std::vector<T>>&& parts)
+{
+    if (parts.size() == 1)
+    {
+        return std::move(parts.front());
+    }
+
+    return Concatenate(static_cast<const std::vector<std::vector<T>>&>(parts));
+}
+
+}  // namespace ip
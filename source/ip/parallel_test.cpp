@@ -0,0 +1,168 @@
+#include "parallel.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using ip::ForEachChunk;
+
+TEST(ForEachChunkTest, ShouldCoverWholeRangeWithContiguousChunks)
+{
+    // Arrange
+    constexpr size_t kCount = 10;
+    constexpr size_t kWorkers = 3;
+    std::vector<std::pair<size_t, size_t>> chunks(kWorkers);
+
+    // Act
+    ForEachChunk(kCount, kWorkers,
+                 [&chunks](size_t chunk, size_t begin, size_t end)
+                 { chunks[chunk] = {begin, end}; });
+
+    // Assert
+    EXPECT_THAT(chunks, ::testing::ElementsAre(std::make_pair(0U, 3U),
+                                               std::make_pair(3U, 6U),
+                                               std::make_pair(6U, 10U)));
+}
+
+TEST(ForEachChunkTest, ShouldNotUseMoreWorkersThanItems)
+{
+    // Arrange
+    std::vector<size_t> calls(4);
+
+    // Act
+    ForEachChunk(2, 4, [&calls](size_t chunk, size_t, size_t)
+                 { ++calls[chunk]; });
+
+    // Assert
+    EXPECT_THAT(calls, ::testing::ElementsAre(1U, 1U, 0U, 0U));
+}
+
+TEST(ForEachChunkTest, ShouldRunSingleEmptyChunkWhenCountIsZero)
+{
+    // Arrange
+    size_t calls = 0;
+
+    // Act
+    ForEachChunk(0, 4,
+                 [&calls](size_t, size_t begin, size_t end)
+                 {
+                     EXPECT_EQ(begin, end);
+                     ++calls;
+                 });
+
+    // Assert
+    EXPECT_EQ(calls, 1U);
+}
+
+TEST(ForEachChunkTest, ShouldRethrowWhenTaskThrows)
+{
+    // Act, Assert
+    EXPECT_THROW(ForEachChunk(8, 4,
+                              [](size_t chunk, size_t, size_t)
+                              {
+                                  if (chunk == 2)
+                                  {
+                                      throw std::runtime_error("chunk failed");
+                                  }
+                              }),
+                 std::runtime_error);
+}
+
+TEST(ForEachChunkTest, ShouldReuseWorkerThreadsAcrossCalls)
+{
+    // Arrange
+    constexpr size_t kCalls = 50;
+    constexpr size_t kWorkers = 4;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    // Act
+    for (size_t call = 0; call < kCalls; ++call)
+    {
+        ForEachChunk(kWorkers, kWorkers,
+                     [&mutex, &threads](size_t, size_t, size_t)
+                     {
+                         const std::lock_guard lock{mutex};
+                         threads.insert(std::this_thread::get_id());
+                     });
+    }
+
+    // Assert
+    EXPECT_LE(threads.size(), ip::WorkerPool::Instance().Threads() + 1);
+}
+
+TEST(ForEachChunkTest, ShouldCompleteWhenTasksRunNestedChunks)
+{
+    // Arrange
+    constexpr size_t kWorkers = 8;
+    std::atomic<size_t> calls{0};
+
+    // Act
+    ForEachChunk(kWorkers, kWorkers,
+                 [&calls](size_t, size_t, size_t)
+                 {
+                     ForEachChunk(kWorkers, kWorkers,
+                                  [&calls](size_t, size_t, size_t)
+                                  { ++calls; });
+                 });
+
+    // Assert
+    EXPECT_EQ(calls.load(), kWorkers * kWorkers);
+}
+
+TEST(ConcatenateTest, ShouldReturnEmptyWhenThereAreNoParts)
+{
+    // Arrange
+    const std::vector<std::vector<int>> parts;
+
+    // Act
+    const auto result = ip::Concatenate(parts);
+
+    // Assert
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(ConcatenateTest, ShouldKeepPartOrderWhenPartsAreJoined)
+{
+    // Arrange
+    const std::vector<std::vector<int>> parts{{1, 2}, {}, {3}, {4, 5}};
+
+    // Act
+    const auto result = ip::Concatenate(parts);
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(1, 2, 3, 4, 5));
+}
+
+TEST(ThreadGroupTest, ShouldRunOffPoolAndJoinOnDestruction)
+{
+    // Arrange
+    constexpr size_t kThreads = 4;
+    std::atomic<size_t> finished{0};
+    const auto pool_threads = ip::WorkerPool::Instance().Threads();
+
+    // Act
+    {
+        ip::ThreadGroup threads;
+
+        for (size_t thread = 0; thread < kThreads; ++thread)
+        {
+            threads.Start([&finished] { ++finished; });
+        }
+    }
+
+    // Assert
+    EXPECT_EQ(finished, kThreads);
+    EXPECT_EQ(ip::WorkerPool::Instance().Threads(), pool_threads);
+}
+
+}  // namespace
@@ -0,0 +1,186 @@
+#include "parser.hpp"
+
+#include <array>
+#include <charconv>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IP_PARSER_SSE41 1
+#include <immintrin.h>
+#endif
+
+namespace ip
+{
+
+namespace
+{
+
+bool IsDigit(char symbol) noexcept { return symbol >= '0' && symbol <= '9'; }
+
+#ifdef IP_PARSER_SSE41
+
+constexpr size_t kBlockSize = 16;
+constexpr size_t kMaxOctetDigits = 3;
+constexpr uint32_t kBytePositions = 0x01010101;
+constexpr uint32_t kLastByteMask = 0xFF;
+constexpr int kByteBits = 8;
+constexpr int kMaxOctetValue = std::numeric_limits<uint8_t>::max();
+constexpr char kMaxDigit = 9;
+
+// Shuffle indices that right-align an octet of 1, 2 or 3 digits into a 4-byte
+// lane as [0, hundreds, tens, ones]; 0x80 makes pshufb write a zero byte.
+constexpr std::array<uint32_t, kMaxOctetDigits + 1> kLanePatterns{
+    0, 0x00808080, 0x01008080, 0x02010080};
+constexpr std::array<uint32_t, kMaxOctetDigits + 1> kLaneDigitMasks{
+    0, 0xFF000000, 0xFFFF0000, 0xFFFFFF00};
+
+// Bytes [0, 100, 10, 1] of every lane, fed to pmaddubsw.
+constexpr int kLaneWeights = 0x010A6400;
+
+__attribute__((target("sse4.1"))) const char* ParseIPv4Sse41(
+    const char* first, const char* last, IPv4& ip) noexcept
+{
+    const __m128i input =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const __m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8(
+        _mm_min_epu8(digits, _mm_set1_epi8(kMaxDigit)), digits);
+    const __m128i is_dot = _mm_cmpeq_epi8(input, _mm_set1_epi8('.'));
+
+    const auto digit_mask = static_cast<uint32_t>(_mm_movemask_epi8(is_digit));
+    const auto dot_mask = static_cast<uint32_t>(_mm_movemask_epi8(is_dot));
+
+    std::array<uint32_t, 4> lanes{};
+    uint32_t position = 0;
+
+    for (size_t i = 0; i < lanes.size(); ++i)
+    {
+        if (position >= kBlockSize)
+        {
+            return ParseIPv4Scalar(first, last, ip);
+        }
+
+        const auto length =
+            static_cast<uint32_t>(__builtin_ctz(~(digit_mask >> position)));
+
+        if (length == 0)
+        {
+            // A leading sign or blank is left to the reference parser.
+            return i == 0 ? ParseIPv4Scalar(first, last, ip) : nullptr;
+        }
+
+        // Zero-padded octets and digits running past the block are rare
+        // enough to take the slow path.
+        if (length > kMaxOctetDigits || position + length >= kBlockSize)
+        {
+            return ParseIPv4Scalar(first, last, ip);
+        }
+
+        lanes[i] = kLanePatterns[length] +
+                   (kLaneDigitMasks[length] & (position * kBytePositions));
+        position += length;
+
+        if (i + 1 < lanes.size())
+        {
+            if (((dot_mask >> position) & 1U) == 0)
+            {
+                return nullptr;
+            }
+
+            ++position;
+        }
+    }
+
+    const __m128i shuffle =
+        _mm_setr_epi32(static_cast<int>(lanes[0]), static_cast<int>(lanes[1]),
+                       static_cast<int>(lanes[2]), static_cast<int>(lanes[3]));
+    const __m128i pairs = _mm_maddubs_epi16(_mm_shuffle_epi8(digits, shuffle),
+                                            _mm_set1_epi32(kLaneWeights));
+    const __m128i values = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+
+    if (_mm_movemask_epi8(
+            _mm_cmpgt_epi32(values, _mm_set1_epi32(kMaxOctetValue))) != 0)
+    {
+        return nullptr;
+    }
+
+    const __m128i packed = _mm_packus_epi16(_mm_packus_epi32(values, values),
+                                            _mm_setzero_si128());
+    const auto octets = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+
+    ip = IPv4(static_cast<uint8_t>(octets & kLastByteMask),
+              static_cast<uint8_t>((octets >> kByteBits) & kLastByteMask),
+              static_cast<uint8_t>((octets >> (2 * kByteBits)) & kLastByteMask),
+              static_cast<uint8_t>(octets >> (3 * kByteBits)));
+
+    return first + position;
+}
+
+bool HasSse41() noexcept
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("sse4.1") != 0;
+}
+
+const bool kUseSse41 = HasSse41();
+
+#endif
+
+}  // namespace
+
+const char* ParseIPv4(const char* first, const char* last, IPv4& ip) noexcept
+{
+#ifdef IP_PARSER_SSE41
+    if (kUseSse41 && static_cast<size_t>(last - first) >= kBlockSize)
+    {
+        return ParseIPv4Sse41(first, last, ip);
+    }
+#endif
+
+    return ParseIPv4Scalar(first, last, ip);
+}
+
+const char* ParseIPv4Scalar(const char* first, const char* last,
+                            IPv4& ip) noexcept
+{
+    std::array<uint8_t, 4> octets{};
+
+    for (size_t i = 0; i < octets.size(); ++i)
+    {
+        if (i > 0)
+        {
+            if (first == last || *first != '.')
+            {
+                return nullptr;
+            }
+
+            ++first;
+
+            if (first == last || !IsDigit(*first))
+            {
+                return nullptr;
+            }
+        }
+
+        int octet = 0;
+
+        const auto [next, error] = std::from_chars(first, last, octet);
+
+        if (error != std::errc{} ||
+            octet < std::numeric_limits<uint8_t>::min() ||
+            octet > std::numeric_limits<uint8_t>::max())
+        {
+            return nullptr;
+        }
+
+        octets[i] = static_cast<uint8_t>(octet);
+        first = next;
+    }
+
+    ip = IPv4(octets[0], octets[1], octets[2], octets[3]);
+
+    return first;
+}
+
+}  // namespace ip
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+// Parses a dotted-quad address at the start of [first, last) without stream
+// state or locale lookups. Octets are plain decimal digits, so unlike
+// operator>>, which reads the first octet as a signed int, "+1.2.3.4" is
+// rejected. Returns a pointer past the last octet, or nullptr when the input
+// does not start with a valid address. When at least 16 bytes are readable
+// and the CPU supports SSE4.1 the address is decoded with a vector kernel.
+const char* ParseIPv4(const char* first, const char* last, IPv4& ip) noexcept;
+
+// Reference implementation behind ParseIPv4, also used for short tails.
+const char* ParseIPv4Scalar(const char* first, const char* last,
+                            IPv4& ip) noexcept;
+
+}  // namespace ip
@@ -0,0 +1,170 @@
+#include "parser.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "ipv4.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::IPv4;
+using ip::ParseIPv4;
+using ip::ParseIPv4Scalar;
+
+const char* Parse(std::string_view input, IPv4& ip)
+{
+    return ParseIPv4(input.data(), input.data() + input.size(), ip);
+}
+
+class ParseIPv4FailTest
+    : public ::testing::TestWithParam<
+          std::tuple<std::string_view, std::string_view>>
+{
+};
+
+TEST_P(ParseIPv4FailTest, ShouldReturnNullWhenInputIsInvalid)
+{
+    // Arrange
+    const auto& [description, input] = GetParam();
+
+    IPv4 ip;
+
+    // Act
+    const auto* result = Parse(input, ip);
+
+    // Assert
+    EXPECT_EQ(result, nullptr) << "Test case: "sv << description;
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParseIPv4FailCases, ParseIPv4FailTest,
+    ::testing::Values(
+        std::make_tuple("Empty input"sv, ""sv),
+        std::make_tuple("Less than four octets"sv, "192.168.1"sv),
+        std::make_tuple("Octet greater than 255"sv, "192.168.256.1"sv),
+        std::make_tuple("Negative octet"sv, "192.168.-1.1"sv),
+        std::make_tuple("Signed first octet"sv, "+1.2.3.4"sv),
+        std::make_tuple("Missing dots"sv, "192.16811"sv),
+        std::make_tuple("Dots in wrong places"sv, "192.168.1."sv),
+        std::make_tuple("Non-numeric characters"sv, "192.168.a.1"sv),
+        std::make_tuple("Missing last octet"sv, "192.168."sv),
+        std::make_tuple("Missing first octet"sv, ".168.1.1"sv),
+        std::make_tuple("Extra spaces"sv, "192 .168.1.1"sv),
+        std::make_tuple("Octet overflows int"sv, "99999999999.1.1.1"sv)));
+
+class ParseIPv4SuccessTest
+    : public ::testing::TestWithParam<
+          std::tuple<std::string_view, IPv4, size_t>>
+{
+};
+
+TEST_P(ParseIPv4SuccessTest, ShouldParseIPv4AddressWhenInputIsValid)
+{
+    // Arrange
+    const auto& [input, expected_ip, expected_length] = GetParam();
+
+    IPv4 ip;
+
+    // Act
+    const auto* result = Parse(input, ip);
+
+    // Assert
+    ASSERT_NE(result, nullptr) << "Input: "sv << input;
+    EXPECT_EQ(ip, expected_ip);
+    EXPECT_EQ(static_cast<size_t>(result - input.data()), expected_length);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParseIPv4SuccessCases, ParseIPv4SuccessTest,
+    ::testing::Values(
+        std::make_tuple("192.168.1.1"sv, IPv4(192, 168, 1, 1), 11U),
+        std::make_tuple("192.168.1.1 "sv, IPv4(192, 168, 1, 1), 11U),
+        std::make_tuple("192.168.1.1\t111\t0"sv, IPv4(192, 168, 1, 1), 11U),
+        std::make_tuple("192.168.1.1extra"sv, IPv4(192, 168, 1, 1), 11U),
+        std::make_tuple("0.0.0.0"sv, IPv4(0, 0, 0, 0), 7U),
+        std::make_tuple("255.255.255.255"sv, IPv4(255, 255, 255, 255), 15U),
+        std::make_tuple("010.001.0.00255"sv, IPv4(10, 1, 0, 255), 15U)));
+
+class ParseIPv4BlockTest : public ::testing::TestWithParam<std::string_view>
+{
+};
+
+TEST_P(ParseIPv4BlockTest, ShouldMatchScalarParserWhenInputFillsBlock)
+{
+    // Arrange
+    const auto input = std::string{GetParam()} + "\t1234567890123456\n";
+    const auto* const last = input.data() + input.size();
+
+    IPv4 ip;
+    IPv4 expected_ip;
+
+    // Act
+    const auto* result = ParseIPv4(input.data(), last, ip);
+    const auto* expected = ParseIPv4Scalar(input.data(), last, expected_ip);
+
+    // Assert
+    EXPECT_EQ(result, expected) << "Input: "sv << GetParam();
+    EXPECT_EQ(ip, expected_ip) << "Input: "sv << GetParam();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParseIPv4BlockCases, ParseIPv4BlockTest,
+    ::testing::Values(""sv, "192.168.1"sv, "192.168.256.1"sv, "192.168.-1.1"sv,
+                      "192.16811"sv, "192.168.1."sv, "192.168.a.1"sv,
+                      ".168.1.1"sv, "192 .168.1.1"sv, "-0.1.2.3"sv,
+                      "999.1.1.1"sv, "1.2.3.256"sv, "192.168.1.1"sv,
+                      "0.0.0.0"sv, "255.255.255.255"sv, "010.001.0.00255"sv,
+                      "1.2.3.4567"sv, "1.2.3.4.5"sv, "1..2.3"sv));
+
+TEST(ParseIPv4RandomTest, ShouldMatchScalarParserWhenInputIsRandom)
+{
+    // Arrange
+    constexpr std::string_view kSeparators = "....\t -x";
+    constexpr size_t kIterations = 100000;
+    constexpr size_t kMaxGroups = 6;
+    constexpr size_t kMaxGroupDigits = 4;
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<size_t> pick_separator{
+        0, kSeparators.size() - 1};
+    std::uniform_int_distribution<size_t> pick_digits{0, kMaxGroupDigits};
+    std::uniform_int_distribution<int> pick_digit{'0', '9'};
+
+    for (size_t iteration = 0; iteration < kIterations; ++iteration)
+    {
+        std::string line;
+
+        for (size_t group = 0; group < kMaxGroups; ++group)
+        {
+            for (size_t digits = pick_digits(generator); digits > 0; --digits)
+            {
+                line += static_cast<char>(pick_digit(generator));
+            }
+
+            line += kSeparators[pick_separator(generator)];
+        }
+
+        line += "\t1234567890123456";
+
+        IPv4 ip;
+        IPv4 expected_ip;
+
+        // Act
+        const auto* result =
+            ParseIPv4(line.data(), line.data() + line.size(), ip);
+        const auto* expected = ParseIPv4Scalar(
+            line.data(), line.data() + line.size(), expected_ip);
+
+        // Assert
+        ASSERT_EQ(result, expected) << "Input: "sv << line;
+        ASSERT_EQ(ip, expected_ip) << "Input: "sv << line;
+    }
+}
+
+}  // namespace
@@ -0,0 +1,89 @@
+#include "prefix_index.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr uint32_t kOctetBits = std::numeric_limits<uint8_t>::digits;
+constexpr size_t kOctets = 4;
+
+uint8_t FirstOctet(const IPv4& ip) noexcept
+{
+    return static_cast<uint8_t>(ip.ToUint32() >> ((kOctets - 1) * kOctetBits));
+}
+
+}  // namespace
+
+PrefixIndex::PrefixIndex(const IpList& ips) : ips_{ips}
+{
+    const auto* const first = ips_.data();
+    const auto* const last = first + ips_.size();
+
+    for (size_t i = 1; i < kOctetValues; ++i)
+    {
+        const auto value = static_cast<uint8_t>(kOctetValues - i);
+
+        first_octet_offsets_[i] = static_cast<size_t>(
+            std::partition_point(first + first_octet_offsets_[i - 1], last,
+                                 [value](const IPv4& ip) noexcept
+                                 { return FirstOctet(ip) >= value; }) -
+            first);
+    }
+
+    first_octet_offsets_[kOctetValues] = ips_.size();
+}
+
+std::optional<IpListView> PrefixIndex::FindPrefix(
+    const std::array<std::optional<uint8_t>, 4>& mask) const
+{
+    const auto prefix_end =
+        std::find(mask.cbegin(), mask.cend(), std::nullopt) - mask.cbegin();
+    const auto prefix_length = static_cast<size_t>(prefix_end);
+
+    if (std::any_of(mask.cbegin() + prefix_end, mask.cend(),
+                    [](const auto& octet) { return octet.has_value(); }))
+    {
+        return std::nullopt;
+    }
+
+    if (prefix_length == 0)
+    {
+        return IpListView{ips_};
+    }
+
+    const size_t bucket = kOctetValues - 1 - *mask[0];
+
+    const auto* first = ips_.data() + first_octet_offsets_[bucket];
+    const auto* last = ips_.data() + first_octet_offsets_[bucket + 1];
+
+    if (prefix_length > 1)
+    {
+        const auto shift = (kOctets - prefix_length) * kOctetBits;
+
+        uint32_t target = 0;
+
+        for (size_t i = 0; i < prefix_length; ++i)
+        {
+            target = (target << kOctetBits) | *mask[i];
+        }
+
+        const auto prefix = [shift](const IPv4& ip) noexcept
+        { return ip.ToUint32() >> shift; };
+
+        first = std::partition_point(first, last,
+                                     [&prefix, target](const IPv4& ip) noexcept
+                                     { return prefix(ip) > target; });
+        last = std::partition_point(first, last,
+                                    [&prefix, target](const IPv4& ip) noexcept
+                                    { return prefix(ip) == target; });
+    }
+
+    return IpListView{first, static_cast<size_t>(last - first)};
+}
+
+}  // namespace ip
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <optional>
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+// Answers leading-octet mask queries over a list sorted by
+// SortReverseLexicographical, where every such mask matches one contiguous
+// range. The list must outlive the index and stay unchanged.
+class PrefixIndex final
+{
+   public:
+    explicit PrefixIndex(const IpList& ips);
+
+    // Returns the matching slice of the list in O(log n), or std::nullopt when
+    // the set octets of the mask do not form a prefix, e.g. {std::nullopt, 1}.
+    std::optional<IpListView> FindPrefix(
+        const std::array<std::optional<uint8_t>, 4>& mask) const;
+
+   private:
+    static constexpr size_t kOctetValues = 256;
+
+    const IpList& ips_;
+
+    // Start of the addresses with first octet 255 - i, descending order.
+    std::array<size_t, kOctetValues + 1> first_octet_offsets_{};
+};
+
+}  // namespace ip
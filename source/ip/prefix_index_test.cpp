@@ -0,0 +1,144 @@
+#include "prefix_index.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "filter.hpp"
+#include "ipv4.hpp"
+#include "utils.hpp"
+
+namespace
+{
+
+using ip::IpList;
+using ip::IPv4;
+
+using Mask = std::array<std::optional<uint8_t>, 4>;
+
+class PrefixIndexTest : public ::testing::Test
+{
+   protected:
+    void SetUpIndex(IpList&& list_of_ip)
+    {
+        ips = std::move(list_of_ip);
+        ip::SortReverseLexicographical(ips);
+        index = std::make_unique<ip::PrefixIndex>(ips);
+    }
+
+    auto Find(const Mask& mask) const
+    {
+        const auto view = index->FindPrefix(mask);
+
+        return view ? std::optional<IpList>{{view->begin(), view->end()}}
+                    : std::nullopt;
+    }
+
+    IpList ips;
+    std::unique_ptr<ip::PrefixIndex> index;
+};
+
+TEST_F(PrefixIndexTest, ShouldReturnAllIpsWhenMaskIsEmpty)
+{
+    // Arrange
+    SetUpIndex({IPv4(10, 0, 0, 1), IPv4(192, 168, 1, 1)});
+
+    // Act
+    const auto result = Find({});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::Optional(::testing::ElementsAre(
+                            IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1))));
+}
+
+TEST_F(PrefixIndexTest, ShouldReturnRangeWhenFirstOctetIsSet)
+{
+    // Arrange
+    SetUpIndex({IPv4(1, 2, 3, 4), IPv4(46, 70, 0, 1), IPv4(1, 0, 0, 0),
+                IPv4(255, 1, 1, 1), IPv4(0, 1, 1, 1)});
+
+    // Act
+    const auto result = Find({1});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::Optional(::testing::ElementsAre(
+                            IPv4(1, 2, 3, 4), IPv4(1, 0, 0, 0))));
+}
+
+TEST_F(PrefixIndexTest, ShouldReturnRangeWhenTwoLeadingOctetsAreSet)
+{
+    // Arrange
+    SetUpIndex({IPv4(46, 70, 1, 1), IPv4(46, 71, 0, 0), IPv4(46, 69, 255, 255),
+                IPv4(46, 70, 200, 3), IPv4(47, 70, 1, 1)});
+
+    // Act
+    const auto result = Find({46, 70});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::Optional(::testing::ElementsAre(
+                            IPv4(46, 70, 200, 3), IPv4(46, 70, 1, 1))));
+}
+
+TEST_F(PrefixIndexTest, ShouldReturnEmptyRangeWhenNothingMatches)
+{
+    // Arrange
+    SetUpIndex({IPv4(46, 70, 1, 1), IPv4(10, 0, 0, 1)});
+
+    // Act
+    const auto result = Find({46, 70, 1, 2});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::Optional(::testing::IsEmpty()));
+}
+
+TEST_F(PrefixIndexTest, ShouldReturnEmptyRangeWhenListIsEmpty)
+{
+    // Arrange
+    SetUpIndex({});
+
+    // Act
+    const auto result = Find({46});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::Optional(::testing::IsEmpty()));
+}
+
+TEST_F(PrefixIndexTest, ShouldReturnNulloptWhenMaskIsNotPrefix)
+{
+    // Arrange
+    SetUpIndex({IPv4(46, 70, 1, 1)});
+
+    // Act, Assert
+    EXPECT_EQ(index->FindPrefix({std::nullopt, 70}), std::nullopt);
+    EXPECT_EQ(index->FindPrefix({46, std::nullopt, 1}), std::nullopt);
+}
+
+TEST_F(PrefixIndexTest, ShouldMatchFilterWhenPrefixMasksAreQueried)
+{
+    // Arrange
+    IpList list_of_ip;
+
+    for (uint32_t value = 0; value < 100000; ++value)
+    {
+        const auto mixed = value * 2654435761U;
+        list_of_ip.emplace_back(static_cast<uint8_t>((mixed >> 24U) % 4),
+                                static_cast<uint8_t>((mixed >> 16U) % 4),
+                                static_cast<uint8_t>(mixed >> 8U),
+                                static_cast<uint8_t>(mixed));
+    }
+
+    SetUpIndex(std::move(list_of_ip));
+    const ip::Filter filter{ips};
+
+    for (const auto& mask :
+         {Mask{0}, Mask{3}, Mask{2, 1}, Mask{1, 3, 7}, Mask{3, 3, 3, 3},
+          Mask{4}, Mask{0, 0, 0, 0}})
+    {
+        // Act
+        const auto result = Find(mask);
+
+        // Assert
+        EXPECT_THAT(result, ::testing::Optional(filter.FilterByMask(mask)));
+    }
+}
+
+}  // namespace
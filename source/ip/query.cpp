@@ -0,0 +1,733 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "filter.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr size_t kOctets = 4;
+// Bounds the recursion over nested parentheses and negations.
+constexpr size_t kMaxNesting = 256;
+constexpr uint32_t kAllBits = std::numeric_limits<uint32_t>::max();
+
+using Octets = std::array<std::optional<uint8_t>, kOctets>;
+
+struct Token
+{
+    std::string_view text;
+    size_t offset;
+};
+
+bool IsWordSymbol(char symbol) noexcept
+{
+    return std::isalnum(static_cast<unsigned char>(symbol)) != 0 ||
+           symbol == '.' || symbol == '/' || symbol == '-';
+}
+
+// Whether the set octets form a prefix, so that the mask selects one
+// contiguous interval of addresses.
+bool IsPrefix(const Octets& octets) noexcept
+{
+    const auto prefix_end = std::find(octets.cbegin(), octets.cend(),
+                                      std::nullopt);
+
+    return std::none_of(prefix_end, octets.cend(),
+                        [](const auto& octet) { return octet.has_value(); });
+}
+
+AddressRange PrefixRange(const Mask& mask) noexcept
+{
+    return {IPv4::FromUint32(mask.Value()),
+            IPv4::FromUint32(mask.Value() | (kAllBits & ~mask.Bits()))};
+}
+
+RuleSet Complement(const RuleSet& set)
+{
+    std::vector<AddressRange> gaps;
+    uint64_t next = 0;
+
+    for (const auto& range : set.Ranges())
+    {
+        if (range.first.ToUint32() > next)
+        {
+            gaps.push_back({IPv4::FromUint32(static_cast<uint32_t>(next)),
+                            IPv4::FromUint32(range.first.ToUint32() - 1)});
+        }
+
+        next = uint64_t{range.last.ToUint32()} + 1;
+    }
+
+    if (next <= kAllBits)
+    {
+        gaps.push_back({IPv4::FromUint32(static_cast<uint32_t>(next)),
+                        IPv4::FromUint32(kAllBits)});
+    }
+
+    return RuleSet{gaps};
+}
+
+}  // namespace
+
+// Recursive descent parser that simplifies every node as soon as it is built.
+class QueryParser final
+{
+   public:
+    using Node = Query::Node;
+    using Kind = Node::Kind;
+
+    explicit QueryParser(std::string_view text) : text_{text}
+    {
+        Tokenize();
+    }
+
+    Node ParseQuery()
+    {
+        auto root = ParseOr();
+
+        if (position_ != tokens_.size())
+        {
+            Fail("unexpected '" + std::string{tokens_[position_].text} + "'");
+        }
+
+        return root;
+    }
+
+    static Node MakeMask(const Octets& octets)
+    {
+        Node node;
+        node.kind = Kind::kMask;
+        node.octets = octets;
+        node.mask = Mask{octets};
+
+        return node;
+    }
+
+    static Node MakeRanges(RuleSet ranges)
+    {
+        Node node;
+        node.kind = Kind::kRanges;
+        node.ranges = std::move(ranges);
+
+        return node;
+    }
+
+    static bool IsAlways(const Node& node) noexcept
+    {
+        return node.kind == Kind::kMask && node.mask.Bits() == 0;
+    }
+
+    static bool IsNever(const Node& node) noexcept
+    {
+        return node.kind == Kind::kRanges && node.ranges.Empty();
+    }
+
+    // Interval form of nodes that select contiguous ranges, if any.
+    static std::optional<std::vector<AddressRange>> AsRanges(const Node& node)
+    {
+        if (node.kind == Kind::kRanges)
+        {
+            return node.ranges.Ranges();
+        }
+
+        if (node.kind == Kind::kMask && IsPrefix(node.octets))
+        {
+            return std::vector<AddressRange>{PrefixRange(node.mask)};
+        }
+
+        return std::nullopt;
+    }
+
+   private:
+    [[noreturn]] void Fail(const std::string& what) const
+    {
+        const auto offset = position_ < tokens_.size()
+                                ? tokens_[position_].offset
+                                : text_.size();
+
+        throw std::invalid_argument{"Invalid query at offset " +
+                                    std::to_string(offset) + ": " + what};
+    }
+
+    void Tokenize()
+    {
+        for (size_t offset = 0; offset < text_.size();)
+        {
+            const char symbol = text_[offset];
+
+            if (std::isspace(static_cast<unsigned char>(symbol)) != 0)
+            {
+                ++offset;
+            }
+            else if (symbol == '(' || symbol == ')' || symbol == '=')
+            {
+                tokens_.push_back({text_.substr(offset, 1), offset});
+                ++offset;
+            }
+            else if (IsWordSymbol(symbol))
+            {
+                const auto begin = offset;
+
+                while (offset < text_.size() && IsWordSymbol(text_[offset]))
+                {
+                    ++offset;
+                }
+
+                tokens_.push_back({text_.substr(begin, offset - begin), begin});
+            }
+            else
+            {
+                position_ = tokens_.size();
+                tokens_.push_back({text_.substr(offset, 1), offset});
+                Fail("unexpected '" + std::string(1, symbol) + "'");
+            }
+        }
+    }
+
+    bool Accept(std::string_view text)
+    {
+        if (position_ < tokens_.size() && tokens_[position_].text == text)
+        {
+            ++position_;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    std::string_view Next(const char* expected)
+    {
+        if (position_ == tokens_.size())
+        {
+            Fail(std::string{"expected "} + expected);
+        }
+
+        return tokens_[position_++].text;
+    }
+
+    uint8_t ParseOctetValue()
+    {
+        if (!Accept("="))
+        {
+            Fail("expected '='");
+        }
+
+        const auto text = Next("an octet value");
+        const char* const last = text.data() + text.size();
+
+        unsigned value = 0;
+
+        if (const auto [end, error] =
+                std::from_chars(text.data(), last, value);
+            error != std::errc{} || end != last ||
+            value > std::numeric_limits<uint8_t>::max())
+        {
+            --position_;
+            Fail("invalid octet value '" + std::string{text} + "'");
+        }
+
+        return static_cast<uint8_t>(value);
+    }
+
+    Node ParseOr()
+    {
+        std::vector<Node> children{ParseAnd()};
+
+        while (Accept("or"))
+        {
+            children.push_back(ParseAnd());
+        }
+
+        return MakeOr(std::move(children));
+    }
+
+    Node ParseAnd()
+    {
+        std::vector<Node> children{ParseFactor()};
+
+        while (Accept("and"))
+        {
+            children.push_back(ParseFactor());
+        }
+
+        return MakeAnd(std::move(children));
+    }
+
+    void Nest()
+    {
+        if (++depth_ > kMaxNesting)
+        {
+            --position_;
+            Fail("nesting deeper than " + std::to_string(kMaxNesting));
+        }
+    }
+
+    Node ParseFactor()
+    {
+        if (Accept("not"))
+        {
+            Nest();
+            auto node = MakeNot(ParseFactor());
+            --depth_;
+
+            return node;
+        }
+
+        if (Accept("("))
+        {
+            Nest();
+            auto node = ParseOr();
+
+            if (!Accept(")"))
+            {
+                Fail("expected ')'");
+            }
+
+            --depth_;
+
+            return node;
+        }
+
+        if (Accept("cidr"))
+        {
+            const auto rule = Next("an address rule");
+
+            try
+            {
+                return MakeRanges(RuleSet{{ParseAddressRange(rule)}});
+            }
+            catch (const std::invalid_argument&)
+            {
+                --position_;
+                Fail("invalid address rule '" + std::string{rule} + "'");
+            }
+        }
+
+        if (Accept("any"))
+        {
+            Node node;
+            node.kind = Kind::kAnyOctet;
+            node.octet_value = ParseOctetValue();
+
+            return node;
+        }
+
+        const auto name = Next("a predicate");
+
+        if (name.size() == 2 && name[0] == 'o' && name[1] >= '1' &&
+            name[1] <= '4')
+        {
+            Octets octets;
+            octets[static_cast<size_t>(name[1] - '1')] = ParseOctetValue();
+
+            return MakeMask(octets);
+        }
+
+        --position_;
+        Fail("unknown predicate '" + std::string{name} + "'");
+    }
+
+    static Node MakeNot(Node child)
+    {
+        if (child.kind == Kind::kNot)
+        {
+            return std::move(child.children.front());
+        }
+
+        if (const auto ranges = AsRanges(child))
+        {
+            return MakeRanges(Complement(RuleSet{*ranges}));
+        }
+
+        Node node;
+        node.kind = Kind::kNot;
+        node.children.push_back(std::move(child));
+
+        return node;
+    }
+
+    // Octet equalities are merged into a single mask; conflicting ones make
+    // the whole conjunction empty.
+    static Node MakeAnd(std::vector<Node> children)
+    {
+        Octets octets;
+        std::vector<Node> rest;
+
+        for (auto& child : children)
+        {
+            if (IsNever(child))
+            {
+                return std::move(child);
+            }
+
+            if (child.kind != Kind::kMask)
+            {
+                rest.push_back(std::move(child));
+                continue;
+            }
+
+            for (size_t octet = 0; octet < kOctets; ++octet)
+            {
+                if (!child.octets[octet].has_value())
+                {
+                    continue;
+                }
+
+                if (octets[octet].has_value() &&
+                    octets[octet] != child.octets[octet])
+                {
+                    return MakeRanges({});
+                }
+
+                octets[octet] = child.octets[octet];
+            }
+        }
+
+        auto mask = MakeMask(octets);
+
+        if (rest.empty())
+        {
+            return mask;
+        }
+
+        if (!IsAlways(mask))
+        {
+            rest.insert(rest.begin(), std::move(mask));
+        }
+
+        return Combine(Kind::kAnd, std::move(rest));
+    }
+
+    // Ranges and prefix masks are merged into a single rule set, which is
+    // one binary search per address or one slice per interval.
+    static Node MakeOr(std::vector<Node> children)
+    {
+        std::vector<AddressRange> ranges;
+        std::vector<Node> rest;
+
+        for (auto& child : children)
+        {
+            if (IsAlways(child))
+            {
+                return std::move(child);
+            }
+
+            if (const auto child_ranges = AsRanges(child))
+            {
+                ranges.insert(ranges.end(), child_ranges->cbegin(),
+                              child_ranges->cend());
+            }
+            else
+            {
+                rest.push_back(std::move(child));
+            }
+        }
+
+        if (ranges.empty() && !rest.empty())
+        {
+            return Combine(Kind::kOr, std::move(rest));
+        }
+
+        auto merged = MakeRanges(RuleSet{ranges});
+
+        if (rest.empty())
+        {
+            // A single prefix keeps its mask form for the unsorted case.
+            return children.size() == 1 ? std::move(children.front())
+                                        : merged;
+        }
+
+        rest.insert(rest.begin(), std::move(merged));
+
+        return Combine(Kind::kOr, std::move(rest));
+    }
+
+    static Node Combine(Kind kind, std::vector<Node> children)
+    {
+        if (children.size() == 1)
+        {
+            return std::move(children.front());
+        }
+
+        Node node;
+        node.kind = kind;
+        node.children = std::move(children);
+
+        return node;
+    }
+
+    std::string_view text_;
+    std::vector<Token> tokens_;
+    size_t position_{0};
+    size_t depth_{0};
+};
+
+IndexedIpList::IndexedIpList(IpList sorted_ips)
+    : ips_{std::move(sorted_ips)}, prefixes_{ips_}, octets_{ips_}
+{
+}
+
+const IpList& IndexedIpList::Ips() const noexcept { return ips_; }
+
+const PrefixIndex& IndexedIpList::Prefixes() const noexcept
+{
+    return prefixes_;
+}
+
+const OctetIndex& IndexedIpList::Octets() const noexcept { return octets_; }
+
+Query::Query(Node root) : root_{std::move(root)}
+{
+    switch (root_.kind)
+    {
+        case Node::Kind::kRanges:
+            plan_ = QueryPlan::kSortedRanges;
+            break;
+        case Node::Kind::kMask:
+            plan_ = IsPrefix(root_.octets) ? QueryPlan::kSortedRanges
+                                           : QueryPlan::kMaskScan;
+            break;
+        case Node::Kind::kAnyOctet:
+            plan_ = QueryPlan::kOctetScan;
+            break;
+        case Node::Kind::kNot:
+        case Node::Kind::kAnd:
+        case Node::Kind::kOr:
+            plan_ = QueryPlan::kPredicateScan;
+            break;
+    }
+}
+
+Query Query::Parse(std::string_view text)
+{
+    return Query{QueryParser{text}.ParseQuery()};
+}
+
+bool Query::operator()(const IPv4& ip) const noexcept
+{
+    return Evaluate(root_, ip);
+}
+
+QueryPlan Query::Plan() const noexcept { return plan_; }
+
+IpList Query::Run(IpListView ips, bool sorted, size_t workers) const
+{
+    IpArena arena;
+    const auto result = Run(ips, sorted, workers, arena);
+
+    return {result.begin(), result.end()};
+}
+
+IpListView Query::Run(IpListView ips, bool sorted, size_t workers,
+                      IpArena& arena) const
+{
+    const Filter filter{ips, workers};
+
+    switch (plan_)
+    {
+        case QueryPlan::kSortedRanges:
+            if (sorted)
+            {
+                break;
+            }
+
+            return filter.FilterIf(*this, arena);
+        case QueryPlan::kOctetScan:
+            return filter.FilterByOctetValue(root_.octet_value, arena);
+        case QueryPlan::kMaskScan:
+            return filter.FilterByMask(root_.octets, arena);
+        case QueryPlan::kPredicateScan:
+            return filter.FilterIf(*this, arena);
+    }
+
+    const auto ranges = root_.kind == Node::Kind::kRanges
+                            ? root_.ranges.Ranges()
+                            : std::vector{PrefixRange(root_.mask)};
+
+    std::vector<IpListView> slices;
+    size_t count = 0;
+
+    const auto* first = ips.data();
+    const auto* const last = ips.data() + ips.size();
+
+    // The list is descending, so intervals are sliced from the highest one.
+    for (auto range = ranges.crbegin(); range != ranges.crend(); ++range)
+    {
+        first = std::partition_point(first, last,
+                                     [&range](const IPv4& ip) noexcept
+                                     { return ip > range->last; });
+
+        const auto* const slice_last =
+            std::partition_point(first, last,
+                                 [&range](const IPv4& ip) noexcept
+                                 { return ip >= range->first; });
+
+        if (slice_last != first)
+        {
+            slices.emplace_back(first, static_cast<size_t>(slice_last - first));
+            count += slices.back().size();
+        }
+
+        first = slice_last;
+    }
+
+    if (slices.size() <= 1)
+    {
+        return slices.empty() ? IpListView{} : slices.front();
+    }
+
+    IPv4* const out = arena.Allocate(count);
+    auto* end = out;
+
+    for (const auto& slice : slices)
+    {
+        end = std::copy(slice.begin(), slice.end(), end);
+    }
+
+    return {out, count};
+}
+
+IpListView Query::Run(const IndexedIpList& list, size_t workers,
+                      IpArena& arena) const
+{
+    if (root_.kind == Node::Kind::kMask)
+    {
+        if (const auto slice = list.Prefixes().FindPrefix(root_.octets))
+        {
+            return *slice;
+        }
+    }
+
+    // Range plans are already binary searches.
+    if (plan_ != QueryPlan::kSortedRanges)
+    {
+        if (const auto rows = Lookup(root_, list))
+        {
+            return list.Octets().Collect(*rows, arena);
+        }
+    }
+
+    return Run(list.Ips(), true, workers, arena);
+}
+
+std::optional<OctetIndex::Positions> Query::Lookup(const Node& node,
+                                                   const IndexedIpList& list)
+{
+    const auto& index = list.Octets();
+    std::optional<OctetIndex::Positions> rows;
+
+    switch (node.kind)
+    {
+        case Node::Kind::kMask:
+            for (size_t octet = 0; octet < kOctets; ++octet)
+            {
+                if (!node.octets[octet].has_value())
+                {
+                    continue;
+                }
+
+                const auto& matching =
+                    index.WithOctetAt(octet, *node.octets[octet]);
+                rows = rows ? OctetIndex::Intersect(*rows, matching)
+                            : matching;
+            }
+
+            return rows;
+        case Node::Kind::kAnyOctet:
+            return index.WithOctet(node.octet_value);
+        case Node::Kind::kRanges:
+        case Node::Kind::kNot:
+            return std::nullopt;
+        case Node::Kind::kAnd:
+        {
+            // Children without posting lists filter the rows of the others.
+            std::vector<const Node*> rest;
+
+            for (const auto& child : node.children)
+            {
+                if (auto child_rows = Lookup(child, list))
+                {
+                    rows = rows ? OctetIndex::Intersect(*rows, *child_rows)
+                                : std::move(*child_rows);
+                }
+                else
+                {
+                    rest.push_back(&child);
+                }
+            }
+
+            if (rows && !rest.empty())
+            {
+                const auto& ips = list.Ips();
+
+                const auto rejected = [&ips, &rest](uint32_t row)
+                {
+                    return std::any_of(rest.cbegin(), rest.cend(),
+                                       [&ips, row](const Node* child)
+                                       { return !Evaluate(*child, ips[row]); });
+                };
+
+                rows->erase(
+                    std::remove_if(rows->begin(), rows->end(), rejected),
+                    rows->end());
+            }
+
+            return rows;
+        }
+        case Node::Kind::kOr:
+            for (const auto& child : node.children)
+            {
+                const auto child_rows = Lookup(child, list);
+
+                if (!child_rows)
+                {
+                    return std::nullopt;
+                }
+
+                rows = rows ? OctetIndex::Unite(*rows, *child_rows)
+                            : *child_rows;
+            }
+
+            return rows;
+    }
+
+    return std::nullopt;
+}
+
+bool Query::Evaluate(const Node& node, const IPv4& ip) noexcept
+{
+    switch (node.kind)
+    {
+        case Node::Kind::kMask:
+            return ip.Matches(node.mask);
+        case Node::Kind::kAnyOctet:
+            return ip.ContainsOctet(node.octet_value);
+        case Node::Kind::kRanges:
+            return node.ranges.Contains(ip);
+        case Node::Kind::kNot:
+            return !Evaluate(node.children.front(), ip);
+        case Node::Kind::kAnd:
+            return std::all_of(node.children.cbegin(), node.children.cend(),
+                               [&ip](const Node& child)
+                               { return Evaluate(child, ip); });
+        case Node::Kind::kOr:
+            return std::any_of(node.children.cbegin(), node.children.cend(),
+                               [&ip](const Node& child)
+                               { return Evaluate(child, ip); });
+    }
+
+    return false;
+}
+
+}  // namespace ip
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "arena.hpp"
+#include "ipv4.hpp"
+#include "octet_index.hpp"
+#include "prefix_index.hpp"
+#include "rule_set.hpp"
+
+namespace ip
+{
+
+// How a compiled query is executed.
+enum class QueryPlan
+{
+    // Binary searches for each matching interval of a sorted list; also used
+    // for queries matching everything or nothing.
+    kSortedRanges,
+    // The any-octet kernel of SelectByOctetValue.
+    kOctetScan,
+    // The packed-mask kernel of SelectByMask.
+    kMaskScan,
+    // One fused pass evaluating the whole expression per address.
+    kPredicateScan
+};
+
+// A list in SortReverseLexicographical order with the indexes that answer
+// queries over it without a scan. The indexes refer to the list, so it can
+// be neither copied nor moved.
+class IndexedIpList final
+{
+   public:
+    // Throws std::length_error past 2^32 addresses, as OctetIndex does.
+    explicit IndexedIpList(IpList sorted_ips);
+
+    IndexedIpList(const IndexedIpList&) = delete;
+    IndexedIpList& operator=(const IndexedIpList&) = delete;
+
+    const IpList& Ips() const noexcept;
+
+    const PrefixIndex& Prefixes() const noexcept;
+
+    const OctetIndex& Octets() const noexcept;
+
+   private:
+    IpList ips_;
+    PrefixIndex prefixes_;
+    OctetIndex octets_;
+};
+
+// A filter written in a small query language and compiled into a plan:
+//
+//   query   := term ("or" term)*
+//   term    := factor ("and" factor)*
+//   factor  := "not" factor | "(" query ")" | "o1".."o4" "=" octet
+//            | "any" "=" octet | "cidr" rule
+//
+// where a rule is anything ParseAddressRange accepts, e.g.
+// "o1=46 and o2=70", "any=46" or "not cidr 10.0.0.0/8". Octet equalities
+// joined by "and" are fused into one mask, and ranges joined by "or" into
+// one rule set.
+class Query final
+{
+   public:
+    // Throws std::invalid_argument naming the offset of a syntax error, which
+    // includes nesting more than 256 parentheses and negations.
+    static Query Parse(std::string_view text);
+
+    bool operator()(const IPv4& ip) const noexcept;
+
+    QueryPlan Plan() const noexcept;
+
+    // Returns the matching addresses of `ips` in list order. Range plans
+    // binary search when `sorted` tells that the list is in
+    // SortReverseLexicographical order and fall back to a scan otherwise.
+    IpList Run(IpListView ips, bool sorted, size_t workers = 1) const;
+
+    // Same as above without copying where possible: a single sorted range
+    // is returned as a slice of `ips`, other results are written to `arena`.
+    IpListView Run(IpListView ips, bool sorted, size_t workers,
+                   IpArena& arena) const;
+
+    // Same as above on an indexed list: a prefix mask is one PrefixIndex
+    // lookup, and octet conditions joined by "and" or "or" become posting
+    // list intersections and unions of the OctetIndex instead of a scan.
+    IpListView Run(const IndexedIpList& list, size_t workers,
+                   IpArena& arena) const;
+
+   private:
+    friend class QueryParser;
+
+    struct Node
+    {
+        enum class Kind
+        {
+            kMask,
+            kAnyOctet,
+            kRanges,
+            kNot,
+            kAnd,
+            kOr
+        };
+
+        Kind kind{Kind::kMask};
+        std::array<std::optional<uint8_t>, 4> octets{};
+        Mask mask{octets};
+        uint8_t octet_value{0};
+        RuleSet ranges;
+        std::vector<Node> children;
+    };
+
+    explicit Query(Node root);
+
+    static bool Evaluate(const Node& node, const IPv4& ip) noexcept;
+
+    // Rows of the list matching the node, or std::nullopt when answering it
+    // needs a scan.
+    static std::optional<OctetIndex::Positions> Lookup(
+        const Node& node, const IndexedIpList& list);
+
+    Node root_;
+    QueryPlan plan_;
+};
+
+}  // namespace ip
@@ -0,0 +1,211 @@
+#include "query.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "utils.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::IPv4;
+using ip::IpList;
+using ip::Query;
+using ip::QueryPlan;
+
+IpList RandomIps(size_t count)
+{
+    std::mt19937 engine{11};
+    std::uniform_int_distribution<uint32_t> octet{0, 3};
+    IpList ips;
+
+    // Few distinct octet values, so that every query matches something.
+    for (size_t index = 0; index < count; ++index)
+    {
+        ips.emplace_back(static_cast<uint8_t>(octet(engine) + 45),
+                         static_cast<uint8_t>(octet(engine) + 69),
+                         static_cast<uint8_t>(octet(engine)),
+                         static_cast<uint8_t>(octet(engine) + 45));
+    }
+
+    return ips;
+}
+
+class QueryPlanTest
+    : public ::testing::TestWithParam<std::tuple<std::string_view, QueryPlan>>
+{
+};
+
+TEST_P(QueryPlanTest, ShouldChooseCheapestPlan)
+{
+    // Arrange
+    const auto& [text, plan] = GetParam();
+
+    // Act
+    const auto query = Query::Parse(text);
+
+    // Assert
+    EXPECT_EQ(query.Plan(), plan);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Queries, QueryPlanTest,
+    ::testing::Values(
+        std::make_tuple("o1=46 and o2=70"sv, QueryPlan::kSortedRanges),
+        std::make_tuple("cidr 10.0.0.0/8"sv, QueryPlan::kSortedRanges),
+        std::make_tuple("not cidr 10.0.0.0/8"sv, QueryPlan::kSortedRanges),
+        std::make_tuple("o1=1 or o1=46 or cidr 1.2.3.4-1.2.3.9"sv,
+                        QueryPlan::kSortedRanges),
+        std::make_tuple("o1=1 and o1=2"sv, QueryPlan::kSortedRanges),
+        std::make_tuple("any=46"sv, QueryPlan::kOctetScan),
+        std::make_tuple("o2=70 and (o4=1)"sv, QueryPlan::kMaskScan),
+        std::make_tuple("not not any=46"sv, QueryPlan::kOctetScan),
+        std::make_tuple("any=46 and not o1=46"sv,
+                        QueryPlan::kPredicateScan)));
+
+class QueryRunTest : public ::testing::TestWithParam<std::string_view>
+{
+};
+
+TEST_P(QueryRunTest, ShouldMatchPredicateScanWhetherSortedIndexedOrNot)
+{
+    // Arrange
+    auto ips = RandomIps(5000);
+    const auto query = Query::Parse(GetParam());
+
+    IpList expected;
+    std::copy_if(ips.cbegin(), ips.cend(), std::back_inserter(expected),
+                 query);
+
+    auto sorted_ips = ips;
+    ip::SortReverseLexicographical(sorted_ips);
+    IpList sorted_expected;
+    std::copy_if(sorted_ips.cbegin(), sorted_ips.cend(),
+                 std::back_inserter(sorted_expected), query);
+
+    const ip::IndexedIpList list{sorted_ips};
+    ip::IpArena arena;
+
+    // Act
+    const auto result = query.Run(ips, false);
+    const auto sorted_result = query.Run(sorted_ips, true);
+    const auto indexed_result = query.Run(list, 1, arena);
+
+    // Assert
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(result, expected);
+    EXPECT_EQ(sorted_result, sorted_expected);
+    EXPECT_EQ(IpList(indexed_result.begin(), indexed_result.end()),
+              sorted_expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Queries, QueryRunTest,
+    ::testing::Values("o1=46"sv, "o1=46 and o2=70"sv, "any=46"sv,
+                      "o2=70 and o4=46"sv, "cidr 46.70.0.0/16"sv,
+                      "not cidr 46.0.0.0/8"sv,
+                      "o1=45 or cidr 47.70.0.0/15 or o1=48"sv,
+                      "any=46 and not (o1=46 or o2=70)"sv,
+                      "(o1=45 and o3=2) or any=71"sv,
+                      "any=46 and cidr 46.0.0.0/7"sv, "o1=45 or any=71"sv));
+
+TEST(QueryTest, ShouldBorrowSourceWhenSortedPlanHasOneRange)
+{
+    // Arrange
+    auto ips = RandomIps(1000);
+    ip::SortReverseLexicographical(ips);
+    ip::IpArena arena;
+
+    // Act
+    const auto result =
+        Query::Parse("o1=46 and o2=70"sv).Run(ips, true, 1, arena);
+
+    // Assert
+    EXPECT_FALSE(result.empty());
+    EXPECT_GE(result.begin(), ips.data());
+    EXPECT_LE(result.end(), ips.data() + ips.size());
+    EXPECT_EQ(arena.Capacity(), 0U);
+}
+
+TEST(QueryTest, ShouldEvaluateOctetPredicates)
+{
+    // Arrange
+    const auto query = Query::Parse("o1=46 and (o2=70 or any=1)"sv);
+
+    // Act & Assert
+    EXPECT_TRUE(query(IPv4(46, 70, 0, 0)));
+    EXPECT_TRUE(query(IPv4(46, 0, 0, 1)));
+    EXPECT_FALSE(query(IPv4(46, 0, 0, 2)));
+    EXPECT_FALSE(query(IPv4(1, 70, 0, 0)));
+}
+
+TEST(QueryTest, ShouldMatchNothingWhenOctetConditionsConflict)
+{
+    // Arrange
+    const auto query = Query::Parse("o1=1 and o2=2 and o1=3"sv);
+
+    // Act & Assert
+    EXPECT_FALSE(query(IPv4(1, 2, 0, 0)));
+    EXPECT_FALSE(query(IPv4(3, 2, 0, 0)));
+}
+
+class QueryParseFailTest : public ::testing::TestWithParam<std::string_view>
+{
+};
+
+TEST_P(QueryParseFailTest, ShouldThrowWhenQueryIsInvalid)
+{
+    // Act & Assert
+    EXPECT_THROW(Query::Parse(GetParam()), std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(Queries, QueryParseFailTest,
+                         ::testing::Values(""sv, "o5=1"sv, "o1=256"sv,
+                                           "o1 46"sv, "any="sv, "(o1=1"sv,
+                                           "o1=1 o2=2"sv, "o1=1 and"sv,
+                                           "cidr 10.0.0.0/40"sv, "cidr"sv,
+                                           "o1=1 & o2=2"sv, "not"sv));
+
+TEST(QueryNestingTest, ShouldParseNestingUpToLimit)
+{
+    // Arrange
+    constexpr size_t kLevels = 128;
+    const auto text = std::string(kLevels, '(') + "not o1=1" +
+                      std::string(kLevels, ')');
+
+    // Act
+    const auto query = Query::Parse(text);
+
+    // Assert
+    EXPECT_TRUE(query(IPv4(2, 0, 0, 0)));
+    EXPECT_FALSE(query(IPv4(1, 0, 0, 0)));
+}
+
+TEST(QueryNestingTest, ShouldThrowWhenNestingIsTooDeep)
+{
+    // Arrange
+    constexpr size_t kLevels = 30000;
+    const auto parentheses = std::string(kLevels, '(') + "o1=1" +
+                             std::string(kLevels, ')');
+    std::string negations;
+
+    for (size_t level = 0; level < kLevels; ++level)
+    {
+        negations += "not ";
+    }
+
+    negations += "o1=1";
+
+    // Act & Assert
+    EXPECT_THROW(Query::Parse(parentheses), std::invalid_argument);
+    EXPECT_THROW(Query::Parse(negations), std::invalid_argument);
+}
+
+}  // namespace
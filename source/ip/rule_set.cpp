@@ -0,0 +1,184 @@
+#include "rule_set.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "parser.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr unsigned kAddressBits = std::numeric_limits<uint32_t>::digits;
+constexpr uint32_t kAllBits = std::numeric_limits<uint32_t>::max();
+
+std::string_view Trim(std::string_view text) noexcept
+{
+    const auto is_blank = [](char symbol)
+    { return std::isspace(static_cast<unsigned char>(symbol)) != 0; };
+
+    while (!text.empty() && is_blank(text.front()))
+    {
+        text.remove_prefix(1);
+    }
+
+    while (!text.empty() && is_blank(text.back()))
+    {
+        text.remove_suffix(1);
+    }
+
+    return text;
+}
+
+[[noreturn]] void ThrowInvalidRule(std::string_view rule)
+{
+    throw std::invalid_argument{"Invalid address rule: " + std::string{rule}};
+}
+
+// Parses an address that must span the whole text.
+uint32_t ParseAddress(std::string_view text, std::string_view rule)
+{
+    IPv4 ip;
+    const char* const last = text.data() + text.size();
+
+    if (ParseIPv4(text.data(), last, ip) != last)
+    {
+        ThrowInvalidRule(rule);
+    }
+
+    return ip.ToUint32();
+}
+
+}  // namespace
+
+AddressRange ParseAddressRange(std::string_view rule)
+{
+    const auto text = Trim(rule);
+
+    if (const auto slash = text.find('/'); slash != std::string_view::npos)
+    {
+        const auto address = ParseAddress(Trim(text.substr(0, slash)), rule);
+        const auto length_text = Trim(text.substr(slash + 1));
+        const char* const last = length_text.data() + length_text.size();
+
+        unsigned length = 0;
+
+        if (const auto [end, error] =
+                std::from_chars(length_text.data(), last, length);
+            error != std::errc{} || end != last || length > kAddressBits)
+        {
+            ThrowInvalidRule(rule);
+        }
+
+        const uint32_t host_bits =
+            length == kAddressBits ? 0 : kAllBits >> length;
+
+        return {IPv4::FromUint32(address & ~host_bits),
+                IPv4::FromUint32(address | host_bits)};
+    }
+
+    if (const auto dash = text.find('-'); dash != std::string_view::npos)
+    {
+        const auto first = ParseAddress(Trim(text.substr(0, dash)), rule);
+        const auto last = ParseAddress(Trim(text.substr(dash + 1)), rule);
+
+        if (first > last)
+        {
+            ThrowInvalidRule(rule);
+        }
+
+        return {IPv4::FromUint32(first), IPv4::FromUint32(last)};
+    }
+
+    const auto address = IPv4::FromUint32(ParseAddress(text, rule));
+
+    return {address, address};
+}
+
+RuleSet::RuleSet(const std::vector<AddressRange>& ranges)
+{
+    auto sorted = ranges;
+
+    std::sort(sorted.begin(), sorted.end(),
+              [](const AddressRange& left, const AddressRange& right)
+              { return left.first < right.first; });
+
+    for (const auto& range : sorted)
+    {
+        const auto first = range.first.ToUint32();
+        const auto last = std::max(first, range.last.ToUint32());
+
+        // Overlapping and adjacent intervals are merged, which keeps the
+        // table minimal and the lookup a plain predecessor search.
+        if (!lasts_.empty() &&
+            (lasts_.back() == kAllBits || first <= lasts_.back() + 1))
+        {
+            lasts_.back() = std::max(lasts_.back(), last);
+        }
+        else
+        {
+            firsts_.push_back(first);
+            lasts_.push_back(last);
+        }
+    }
+}
+
+RuleSet RuleSet::Parse(std::string_view rules)
+{
+    std::vector<AddressRange> ranges;
+
+    while (!rules.empty())
+    {
+        const auto line_end = rules.find('\n');
+        const auto line = Trim(rules.substr(0, line_end));
+
+        rules.remove_prefix(line_end == std::string_view::npos ? rules.size()
+                                                               : line_end + 1);
+
+        if (!line.empty() && line.front() != '#')
+        {
+            ranges.push_back(ParseAddressRange(line));
+        }
+    }
+
+    return RuleSet{ranges};
+}
+
+bool RuleSet::Contains(const IPv4& ip) const noexcept
+{
+    const auto value = ip.ToUint32();
+    const auto next = std::upper_bound(firsts_.cbegin(), firsts_.cend(), value);
+
+    if (next == firsts_.cbegin())
+    {
+        return false;
+    }
+
+    return value <= lasts_[static_cast<size_t>(next - firsts_.cbegin()) - 1];
+}
+
+size_t RuleSet::Size() const noexcept { return firsts_.size(); }
+
+std::vector<AddressRange> RuleSet::Ranges() const
+{
+    std::vector<AddressRange> ranges;
+    ranges.reserve(firsts_.size());
+
+    for (size_t interval = 0; interval < firsts_.size(); ++interval)
+    {
+        ranges.push_back({IPv4::FromUint32(firsts_[interval]),
+                          IPv4::FromUint32(lasts_[interval])});
+    }
+
+    return ranges;
+}
+
+bool RuleSet::Empty() const noexcept { return firsts_.empty(); }
+
+}  // namespace ip
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+// Inclusive range of addresses.
+struct AddressRange
+{
+    IPv4 first;
+    IPv4 last;
+};
+
+// Parses a single address "10.0.0.1", a CIDR block "192.168.4.0/22" or an
+// inclusive range "10.0.0.1-10.0.0.9", surrounded by optional blanks. Host
+// bits of a CIDR address are ignored. Throws std::invalid_argument when the
+// rule is malformed.
+AddressRange ParseAddressRange(std::string_view rule);
+
+// A set of addresses given as any number of possibly overlapping ranges,
+// compiled into sorted disjoint intervals so that a lookup is one binary
+// search however many rules there are.
+class RuleSet final
+{
+   public:
+    RuleSet() = default;
+
+    explicit RuleSet(const std::vector<AddressRange>& ranges);
+
+    // Parses one rule per line as ParseAddressRange does; blank lines and
+    // lines starting with '#' are skipped.
+    static RuleSet Parse(std::string_view rules);
+
+    bool Contains(const IPv4& ip) const noexcept;
+
+    // Lets a rule set be passed to Filter::FilterIf directly.
+    bool operator()(const IPv4& ip) const noexcept { return Contains(ip); }
+
+    // Number of disjoint intervals left after merging.
+    size_t Size() const noexcept;
+
+    // The merged intervals in ascending order.
+    std::vector<AddressRange> Ranges() const;
+
+    bool Empty() const noexcept;
+
+   private:
+    // Interval i is [firsts_[i], lasts_[i]]; both are ascending and the
+    // intervals neither overlap nor touch.
+    std::vector<uint32_t> firsts_;
+    std::vector<uint32_t> lasts_;
+};
+
+}  // namespace ip
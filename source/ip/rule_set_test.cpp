@@ -0,0 +1,167 @@
+#include "rule_set.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::AddressRange;
+using ip::IPv4;
+using ip::ParseAddressRange;
+using ip::RuleSet;
+
+class ParseAddressRangeTest
+    : public ::testing::TestWithParam<
+          std::tuple<std::string_view, IPv4, IPv4>>
+{
+};
+
+TEST_P(ParseAddressRangeTest, ShouldReturnInclusiveBoundsWhenRuleIsValid)
+{
+    // Arrange
+    const auto& [rule, first, last] = GetParam();
+
+    // Act
+    const auto range = ParseAddressRange(rule);
+
+    // Assert
+    EXPECT_EQ(range.first, first);
+    EXPECT_EQ(range.last, last);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Rules, ParseAddressRangeTest,
+    ::testing::Values(
+        std::make_tuple("10.0.0.0/8"sv, IPv4(10, 0, 0, 0),
+                        IPv4(10, 255, 255, 255)),
+        std::make_tuple("192.168.4.0/22"sv, IPv4(192, 168, 4, 0),
+                        IPv4(192, 168, 7, 255)),
+        std::make_tuple("192.168.5.7/22"sv, IPv4(192, 168, 4, 0),
+                        IPv4(192, 168, 7, 255)),
+        std::make_tuple("0.0.0.0/0"sv, IPv4(0, 0, 0, 0),
+                        IPv4(255, 255, 255, 255)),
+        std::make_tuple("1.2.3.4/32"sv, IPv4(1, 2, 3, 4), IPv4(1, 2, 3, 4)),
+        std::make_tuple(" 1.2.3.4 - 1.2.4.0\t"sv, IPv4(1, 2, 3, 4),
+                        IPv4(1, 2, 4, 0)),
+        std::make_tuple("8.8.8.8"sv, IPv4(8, 8, 8, 8), IPv4(8, 8, 8, 8))));
+
+class ParseAddressRangeFailTest
+    : public ::testing::TestWithParam<std::string_view>
+{
+};
+
+TEST_P(ParseAddressRangeFailTest, ShouldThrowWhenRuleIsInvalid)
+{
+    // Act & Assert
+    EXPECT_THROW(ParseAddressRange(GetParam()), std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(Rules, ParseAddressRangeFailTest,
+                         ::testing::Values(""sv, "10.0.0.0/33"sv,
+                                           "10.0.0.0/"sv, "10.0.0.0/8x"sv,
+                                           "10.0.0/8"sv, "1.2.3.4-1.2.3.3"sv,
+                                           "1.2.3.4-"sv, "1.2.3.4 5"sv,
+                                           "256.0.0.0"sv));
+
+TEST(RuleSetTest, ShouldMergeOverlappingAndAdjacentRanges)
+{
+    // Arrange
+    const std::vector<AddressRange> ranges{
+        {IPv4(10, 0, 0, 10), IPv4(10, 0, 0, 20)},
+        {IPv4(10, 0, 0, 0), IPv4(10, 0, 0, 9)},
+        {IPv4(10, 0, 0, 15), IPv4(10, 0, 0, 30)},
+        {IPv4(10, 0, 0, 40), IPv4(10, 0, 0, 50)},
+        {IPv4(255, 255, 255, 0), IPv4(255, 255, 255, 255)},
+        {IPv4(255, 255, 255, 255), IPv4(255, 255, 255, 255)}};
+
+    // Act
+    const RuleSet rules{ranges};
+
+    // Assert
+    EXPECT_EQ(rules.Size(), 3U);
+    EXPECT_TRUE(rules.Contains(IPv4(10, 0, 0, 0)));
+    EXPECT_TRUE(rules.Contains(IPv4(10, 0, 0, 30)));
+    EXPECT_FALSE(rules.Contains(IPv4(10, 0, 0, 31)));
+    EXPECT_TRUE(rules.Contains(IPv4(10, 0, 0, 45)));
+    EXPECT_FALSE(rules.Contains(IPv4(9, 255, 255, 255)));
+    EXPECT_TRUE(rules.Contains(IPv4(255, 255, 255, 255)));
+}
+
+TEST(RuleSetTest, ShouldContainNothingWhenEmpty)
+{
+    // Arrange
+    const RuleSet rules;
+
+    // Act & Assert
+    EXPECT_TRUE(rules.Empty());
+    EXPECT_FALSE(rules.Contains(IPv4(0, 0, 0, 0)));
+}
+
+TEST(RuleSetTest, ShouldSkipCommentsAndBlankLinesWhenParsing)
+{
+    // Act
+    const auto rules = RuleSet::Parse(
+        "# allow list\n10.0.0.0/8\n\n  \n192.168.0.1-192.168.0.3\r\n8.8.8.8"sv);
+
+    // Assert
+    EXPECT_EQ(rules.Size(), 3U);
+    EXPECT_TRUE(rules.Contains(IPv4(10, 1, 2, 3)));
+    EXPECT_TRUE(rules.Contains(IPv4(192, 168, 0, 2)));
+    EXPECT_FALSE(rules.Contains(IPv4(192, 168, 0, 4)));
+    EXPECT_TRUE(rules.Contains(IPv4(8, 8, 8, 8)));
+}
+
+TEST(RuleSetTest, ShouldThrowWhenAnyLineIsInvalid)
+{
+    // Act & Assert
+    EXPECT_THROW(RuleSet::Parse("10.0.0.0/8\nnot a rule\n"sv),
+                 std::invalid_argument);
+}
+
+TEST(RuleSetTest, ShouldMatchLinearScanWhenRulesAreRandom)
+{
+    // Arrange
+    constexpr size_t kRules = 1000;
+    constexpr size_t kProbes = 10000;
+    constexpr uint32_t kMaxWidth = 1U << 20;
+    std::mt19937 engine{5};
+    std::vector<AddressRange> ranges;
+
+    for (size_t rule = 0; rule < kRules; ++rule)
+    {
+        const auto first = static_cast<uint32_t>(engine());
+        const auto width = static_cast<uint32_t>(engine() % kMaxWidth);
+        const auto last = first > UINT32_MAX - width ? UINT32_MAX
+                                                     : first + width;
+
+        ranges.push_back({IPv4::FromUint32(first), IPv4::FromUint32(last)});
+    }
+
+    const RuleSet rules{ranges};
+
+    for (size_t probe = 0; probe < kProbes; ++probe)
+    {
+        const auto ip = IPv4::FromUint32(static_cast<uint32_t>(engine()));
+
+        // Act
+        const auto contained = rules.Contains(ip);
+
+        // Assert
+        const auto expected =
+            std::any_of(ranges.cbegin(), ranges.cend(),
+                        [&ip](const AddressRange& range)
+                        { return range.first <= ip && ip <= range.last; });
+
+        ASSERT_EQ(contained, expected) << static_cast<std::string>(ip);
+    }
+}
+
+}  // namespace
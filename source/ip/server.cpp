@@ -0,0 +1,534 @@
+#include "server.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "query.hpp"
+#include "stats.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr std::string_view kCountCommand = "count";
+constexpr size_t kMaxEvents = 64;
+constexpr size_t kReadSize = size_t{16} * 1024;
+// A longer line without a newline is answered with an error and the
+// connection is closed.
+constexpr size_t kMaxRequestLength = size_t{64} * 1024;
+// Buffered requests are answered only while less output is pending, so one
+// response at most goes beyond it.
+constexpr size_t kMaxPendingOutput = size_t{64} * 1024;
+
+[[noreturn]] void ThrowSystemError(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+void AppendAddresses(IpListView ips, std::string& response)
+{
+    const auto offset = response.size();
+    response.resize(offset + ips.size() * (kMaxIPv4Length + 1));
+
+    char* out = response.data() + offset;
+
+    for (const auto& ip : ips)
+    {
+        out = FormatIPv4(ip, out);
+        *out++ = '\n';
+    }
+
+    response.resize(static_cast<size_t>(out - response.data()));
+}
+
+}  // namespace
+
+void AnswerRequest(std::string_view request, const IndexedIpList& list,
+                   IpArena& arena, std::string& response)
+{
+    ScopedPhase phase{"request"};
+    phase.AddBytesIn(request.size());
+
+    const auto response_size = response.size();
+
+    if (!request.empty() && request.back() == '\r')
+    {
+        request.remove_suffix(1);
+    }
+
+    const bool count_only =
+        request.size() > kCountCommand.size() &&
+        request.substr(0, kCountCommand.size()) == kCountCommand &&
+        std::isspace(static_cast<unsigned char>(request[kCountCommand.size()]));
+
+    if (count_only)
+    {
+        request.remove_prefix(kCountCommand.size());
+    }
+
+    arena.Reset();
+
+    try
+    {
+        const auto matches = Query::Parse(request).Run(list, 1, arena);
+
+        phase.AddRowsIn(list.Ips().size());
+        phase.AddRowsOut(matches.size());
+
+        if (count_only)
+        {
+            response += std::to_string(matches.size());
+            response += '\n';
+        }
+        else
+        {
+            AppendAddresses(matches, response);
+        }
+    }
+    catch (const std::invalid_argument& error)
+    {
+        phase.AddMalformed(1);
+
+        response += "error: ";
+        response += error.what();
+        response += '\n';
+    }
+
+    response += '\n';
+    phase.AddBytesOut(response.size() - response_size);
+}
+
+// Owns an epoll instance and the connections it accepted. The listening
+// socket is shared with EPOLLEXCLUSIVE, so a new connection wakes a single
+// worker.
+class QueryServer::Worker final
+{
+   public:
+    explicit Worker(QueryServer& server) : server_{server}
+    {
+        epoll_ = FileDescriptor{::epoll_create1(EPOLL_CLOEXEC)};
+
+        if (epoll_.Get() < 0)
+        {
+            ThrowSystemError("Failed to create an epoll instance");
+        }
+
+        Watch(EPOLL_CTL_ADD, server_.listener_.Get(), EPOLLIN | EPOLLEXCLUSIVE);
+        Watch(EPOLL_CTL_ADD, server_.stop_event_.Get(), EPOLLIN);
+    }
+
+    void Run()
+    {
+        std::array<epoll_event, kMaxEvents> events{};
+
+        for (;;)
+        {
+            const int count = ::epoll_wait(epoll_.Get(), events.data(),
+                                           static_cast<int>(events.size()), -1);
+
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                ThrowSystemError("Failed to wait for socket events");
+            }
+
+            if (auto latest = server_.Refresh(generation_))
+            {
+                dataset_ = std::move(latest);
+            }
+
+            for (int index = 0; index < count; ++index)
+            {
+                const auto& event = events[static_cast<size_t>(index)];
+                const int fd = event.data.fd;
+
+                if (fd == server_.stop_event_.Get())
+                {
+                    return;
+                }
+
+                if (fd == server_.listener_.Get())
+                {
+                    Accept();
+                    continue;
+                }
+
+                const auto connection = connections_.find(fd);
+
+                // Closing the socket also removes it from the epoll set.
+                if (connection != connections_.end() &&
+                    !Handle(connection->second, event.events))
+                {
+                    connections_.erase(connection);
+                }
+            }
+        }
+    }
+
+   private:
+    struct Connection
+    {
+        FileDescriptor socket;
+        std::string input;
+        std::string output;
+        size_t written{0};
+        uint32_t events{0};
+        // Set once the peer is done sending or the request was too long:
+        // the connection closes after the pending output is written.
+        bool closing{false};
+    };
+
+    void Watch(int operation, int fd, uint32_t events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+
+        if (::epoll_ctl(epoll_.Get(), operation, fd, &event) != 0)
+        {
+            ThrowSystemError("Failed to watch a socket");
+        }
+    }
+
+    void Accept()
+    {
+        for (;;)
+        {
+            FileDescriptor socket{
+                ::accept4(server_.listener_.Get(), nullptr, nullptr,
+                          SOCK_NONBLOCK | SOCK_CLOEXEC)};
+
+            if (socket.Get() < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                {
+                    continue;
+                }
+
+                // Out of descriptors and the like leave the connection
+                // queued for a later attempt.
+                return;
+            }
+
+            const int fd = socket.Get();
+            constexpr uint32_t kEvents = EPOLLIN | EPOLLRDHUP;
+
+            Watch(EPOLL_CTL_ADD, fd, kEvents);
+            connections_[fd] = Connection{std::move(socket), {}, {}, 0,
+                                          kEvents, false};
+        }
+    }
+
+    // Returns false once the connection is to be closed.
+    bool Handle(Connection& connection, uint32_t events)
+    {
+        if ((events & EPOLLERR) != 0)
+        {
+            return false;
+        }
+
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0 &&
+            !Receive(connection))
+        {
+            connection.closing = true;
+        }
+
+        // Requests left over by the output limit are answered once the
+        // socket took the output, since no new input may arrive for them.
+        do
+        {
+            Answer(connection);
+
+            if (!Send(connection))
+            {
+                return false;
+            }
+        } while (connection.output.empty() &&
+                 connection.input.find('\n') != std::string::npos);
+
+        const bool pending = connection.written < connection.output.size();
+
+        if (!pending && connection.closing)
+        {
+            return false;
+        }
+
+        // Requests are not read while a response is pending, and Answer
+        // stops at kMaxPendingOutput, which bounds both buffers of a client
+        // that does not read its responses.
+        const uint32_t wanted = pending ? EPOLLOUT : EPOLLIN | EPOLLRDHUP;
+
+        if (wanted != connection.events)
+        {
+            Watch(EPOLL_CTL_MOD, connection.socket.Get(), wanted);
+            connection.events = wanted;
+        }
+
+        return true;
+    }
+
+    // Returns false once the peer has closed its side or failed.
+    static bool Receive(Connection& connection)
+    {
+        std::array<char, kReadSize> buffer;
+
+        while (connection.input.size() <= kMaxRequestLength)
+        {
+            const auto size =
+                ::read(connection.socket.Get(), buffer.data(), buffer.size());
+
+            if (size > 0)
+            {
+                connection.input.append(buffer.data(),
+                                        static_cast<size_t>(size));
+                continue;
+            }
+
+            if (size < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            return size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+
+        return true;
+    }
+
+    void Answer(Connection& connection)
+    {
+        size_t begin = 0;
+
+        for (auto end = connection.input.find('\n');
+             end != std::string::npos &&
+             connection.output.size() < kMaxPendingOutput;
+             end = connection.input.find('\n', begin))
+        {
+            AnswerRequest(
+                std::string_view{connection.input}.substr(begin, end - begin),
+                *dataset_, arena_, connection.output);
+            begin = end + 1;
+        }
+
+        connection.input.erase(0, begin);
+
+        if (connection.input.size() > kMaxRequestLength &&
+            connection.input.find('\n') == std::string::npos)
+        {
+            connection.output += "error: request too long\n\n";
+            connection.input.clear();
+            connection.closing = true;
+        }
+    }
+
+    // Returns false when the socket failed.
+    static bool Send(Connection& connection)
+    {
+        while (connection.written < connection.output.size())
+        {
+            const auto size =
+                ::send(connection.socket.Get(),
+                       connection.output.data() + connection.written,
+                       connection.output.size() - connection.written,
+                       MSG_NOSIGNAL);
+
+            if (size >= 0)
+            {
+                connection.written += static_cast<size_t>(size);
+                continue;
+            }
+
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        connection.output.clear();
+        connection.written = 0;
+
+        return true;
+    }
+
+    QueryServer& server_;
+    FileDescriptor epoll_;
+    std::unordered_map<int, Connection> connections_;
+    Dataset dataset_;
+    uint64_t generation_{0};
+    IpArena arena_;
+};
+
+QueryServer::QueryServer(const std::string& socket_path, IpList sorted_ips,
+                         size_t workers)
+    : socket_path_{socket_path},
+      workers_{std::max<size_t>(workers, 1)},
+      dataset_{std::make_shared<const IndexedIpList>(std::move(sorted_ips))}
+{
+    sockaddr_un address{};
+
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument{"Invalid socket path: " + socket_path};
+    }
+
+    address.sun_family = AF_UNIX;
+    socket_path.copy(address.sun_path, socket_path.size());
+
+    listener_ = FileDescriptor{
+        ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+
+    if (listener_.Get() < 0)
+    {
+        ThrowSystemError("Failed to create a socket");
+    }
+
+    // A socket file left by a previous run would make bind fail.
+    if (struct stat file_stat{};
+        ::lstat(socket_path.c_str(), &file_stat) == 0 &&
+        S_ISSOCK(file_stat.st_mode))
+    {
+        ::unlink(socket_path.c_str());
+    }
+
+    if (::bind(listener_.Get(), reinterpret_cast<const sockaddr*>(&address),
+               sizeof(address)) != 0)
+    {
+        ThrowSystemError("Failed to bind " + socket_path);
+    }
+
+    if (::listen(listener_.Get(), SOMAXCONN) != 0)
+    {
+        ::unlink(socket_path.c_str());
+        ThrowSystemError("Failed to listen on " + socket_path);
+    }
+
+    stop_event_ = FileDescriptor{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+
+    if (stop_event_.Get() < 0)
+    {
+        ::unlink(socket_path.c_str());
+        ThrowSystemError("Failed to create an event");
+    }
+}
+
+QueryServer::~QueryServer() { ::unlink(socket_path_.c_str()); }
+
+void QueryServer::Serve()
+{
+    std::vector<std::unique_ptr<Worker>> workers;
+    workers.reserve(workers_);
+
+    for (size_t index = 0; index < workers_; ++index)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    // The first error of a worker stops the others.
+    const auto run = [this, &error_mutex, &error](Worker& worker) noexcept
+    {
+        try
+        {
+            worker.Run();
+        }
+        catch (...)
+        {
+            {
+                const std::lock_guard lock{error_mutex};
+
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+
+            Stop();
+        }
+    };
+
+    {
+        // The event loops run until Stop, so they get threads of their own
+        // rather than holding WorkerPool threads for the server's lifetime.
+        ThreadGroup threads;
+
+        try
+        {
+            for (size_t index = 1; index < workers.size(); ++index)
+            {
+                threads.Start([&run, &worker = *workers[index]]
+                              { run(worker); });
+            }
+        }
+        catch (...)
+        {
+            Stop();
+            throw;
+        }
+
+        run(*workers.front());
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void QueryServer::Stop() noexcept
+{
+    const uint64_t increment = 1;
+
+    [[maybe_unused]] const auto written =
+        ::write(stop_event_.Get(), &increment, sizeof(increment));
+}
+
+void QueryServer::Reload(IpList sorted_ips)
+{
+    auto dataset =
+        std::make_shared<const IndexedIpList>(std::move(sorted_ips));
+
+    const std::lock_guard lock{dataset_mutex_};
+    dataset_ = std::move(dataset);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+QueryServer::Dataset QueryServer::Refresh(uint64_t& generation) const
+{
+    if (generation_.load(std::memory_order_acquire) == generation)
+    {
+        return nullptr;
+    }
+
+    const std::lock_guard lock{dataset_mutex_};
+    generation = generation_.load(std::memory_order_relaxed);
+
+    return dataset_;
+}
+
+}  // namespace ip
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "arena.hpp"
+#include "file_descriptor.hpp"
+#include "ipv4.hpp"
+#include "query.hpp"
+
+namespace ip
+{
+
+// Answers one request line of the server protocol, appending the response
+// to `response`:
+//
+//   request  := query | "count" query
+//   response := (line "\n")* "\n"
+//
+// where a query is anything Query::Parse accepts. A query is answered with
+// its matches one per line, "count" with the number of matches, and a
+// malformed request with a single "error: ..." line. `arena` is reset
+// before use.
+void AnswerRequest(std::string_view request, const IndexedIpList& list,
+                   IpArena& arena, std::string& response);
+
+// Serves queries over a sorted address list and its indexes on a Unix domain
+// socket. Each worker thread runs its own epoll loop over the connections it
+// accepted, so clients are served concurrently without locks around the
+// list: every request reads an immutable dataset that Reload replaces as a
+// whole.
+class QueryServer final
+{
+   public:
+    // Binds and listens on `socket_path`, replacing a stale socket file left
+    // there. Throws std::system_error when the socket cannot be set up and
+    // std::invalid_argument when the path is too long for a socket address.
+    QueryServer(const std::string& socket_path, IpList sorted_ips,
+                size_t workers = 1);
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Removes the socket file.
+    ~QueryServer();
+
+    // Serves until Stop, running one worker on the calling thread and the
+    // others on threads of their own. The first error of a worker stops the
+    // others and is rethrown.
+    void Serve();
+
+    // Thread-safe; open connections are closed once their worker sees it.
+    void Stop() noexcept;
+
+    // Thread-safe; requests already running finish on the previous list.
+    void Reload(IpList sorted_ips);
+
+   private:
+    class Worker;
+
+    using Dataset = std::shared_ptr<const IndexedIpList>;
+
+    // Returns the current dataset once `generation` is out of date, or
+    // nullptr while it is still current; workers keep their own copy, so the
+    // lock is only taken after a reload.
+    Dataset Refresh(uint64_t& generation) const;
+
+    std::string socket_path_;
+    size_t workers_;
+    FileDescriptor listener_;
+    // Readable once stopped; level-triggered, so it wakes every worker.
+    FileDescriptor stop_event_;
+
+    mutable std::mutex dataset_mutex_;
+    Dataset dataset_;
+    std::atomic<uint64_t> generation_{1};
+};
+
+}  // namespace ip
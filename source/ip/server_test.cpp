@@ -0,0 +1,281 @@
+#include "server.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "file_descriptor.hpp"
+#include "utils.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::AnswerRequest;
+using ip::FileDescriptor;
+using ip::IndexedIpList;
+using ip::IpArena;
+using ip::IpList;
+using ip::IPv4;
+using ip::QueryServer;
+
+IpList MakeSortedList()
+{
+    IpList ips{IPv4(1, 2, 3, 4),   IPv4(46, 70, 1, 1), IPv4(1, 1, 1, 1),
+               IPv4(46, 70, 2, 2), IPv4(10, 0, 0, 1), IPv4(8, 8, 8, 8)};
+    ip::SortReverseLexicographical(ips);
+
+    return ips;
+}
+
+class AnswerRequestTest
+    : public ::testing::TestWithParam<
+          std::tuple<std::string_view, std::string_view>>
+{
+};
+
+TEST_P(AnswerRequestTest, ShouldWriteResponseEndingWithEmptyLine)
+{
+    // Arrange
+    const auto& [request, expected] = GetParam();
+    const IndexedIpList list{MakeSortedList()};
+    IpArena arena;
+    std::string response;
+
+    // Act
+    AnswerRequest(request, list, arena, response);
+
+    // Assert
+    EXPECT_EQ(response, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Requests, AnswerRequestTest,
+    ::testing::Values(
+        std::make_tuple("o1=46 and o2=70"sv, "46.70.2.2\n46.70.1.1\n\n"sv),
+        std::make_tuple("cidr 1.0.0.0/8\r"sv, "1.2.3.4\n1.1.1.1\n\n"sv),
+        std::make_tuple("count any=1"sv, "4\n\n"sv),
+        std::make_tuple("o2=70 and o4=1"sv, "46.70.1.1\n\n"sv),
+        std::make_tuple("any=8 or o3=1"sv,
+                        "46.70.1.1\n8.8.8.8\n1.1.1.1\n\n"sv),
+        std::make_tuple("o1=99"sv, "\n"sv),
+        std::make_tuple("count o1=99"sv, "0\n\n"sv)));
+
+TEST(AnswerRequestErrorTest, ShouldWriteErrorLineWhenQueryIsMalformed)
+{
+    // Arrange
+    const IndexedIpList list{MakeSortedList()};
+    IpArena arena;
+    std::string response;
+
+    // Act
+    AnswerRequest("o1=", list, arena, response);
+
+    // Assert
+    EXPECT_EQ(response.rfind("error: ", 0), 0);
+    EXPECT_EQ(response.substr(response.size() - 2), "\n\n");
+}
+
+class QueryServerTest : public ::testing::Test
+{
+   protected:
+    void SetUp() override
+    {
+        server_ = std::make_unique<QueryServer>(path_, MakeSortedList(),
+                                                kWorkers);
+        thread_ = std::thread{[this] { server_->Serve(); }};
+    }
+
+    void TearDown() override
+    {
+        server_->Stop();
+        thread_.join();
+        server_.reset();
+    }
+
+    // Sends the requests, closes the sending side and reads until the
+    // server closes the connection, which it may do before reading all.
+    std::string Exchange(std::string_view requests) const
+    {
+        const FileDescriptor socket{::socket(AF_UNIX, SOCK_STREAM, 0)};
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        path_.copy(address.sun_path, path_.size());
+
+        if (::connect(socket.Get(), reinterpret_cast<const sockaddr*>(&address),
+                      sizeof(address)) != 0)
+        {
+            throw std::runtime_error{"Failed to connect"};
+        }
+
+        while (!requests.empty())
+        {
+            const auto size = ::send(socket.Get(), requests.data(),
+                                     requests.size(), MSG_NOSIGNAL);
+
+            if (size <= 0)
+            {
+                break;
+            }
+
+            requests.remove_prefix(static_cast<size_t>(size));
+        }
+
+        ::shutdown(socket.Get(), SHUT_WR);
+
+        std::string response;
+        std::array<char, 4096> buffer;
+
+        for (;;)
+        {
+            const auto size =
+                ::read(socket.Get(), buffer.data(), buffer.size());
+
+            if (size <= 0)
+            {
+                return response;
+            }
+
+            response.append(buffer.data(), static_cast<size_t>(size));
+        }
+    }
+
+    static constexpr size_t kWorkers = 2;
+
+    const std::string path_ = ::testing::TempDir() + "ip_server_test_" +
+                              std::to_string(::getpid()) + ".sock";
+    std::unique_ptr<QueryServer> server_;
+    std::thread thread_;
+};
+
+TEST_F(QueryServerTest, ShouldAnswerPipelinedRequestsInOrder)
+{
+    // Act
+    const auto response = Exchange("count o1=46\no1=8\nnot valid\n");
+
+    // Assert
+    EXPECT_EQ(response.rfind("2\n\n8.8.8.8\n\nerror: ", 0), 0);
+}
+
+TEST_F(QueryServerTest, ShouldAnswerEveryRequestWhenResponsesExceedOutputLimit)
+{
+    // Arrange
+    constexpr size_t kRequests = 10000;
+
+    std::string requests;
+    std::string expected;
+
+    for (size_t request = 0; request < kRequests; ++request)
+    {
+        requests += "o1=46\n";
+        expected += "46.70.2.2\n46.70.1.1\n\n";
+    }
+
+    // Act
+    const auto response = Exchange(requests);
+
+    // Assert
+    EXPECT_EQ(response, expected);
+}
+
+TEST_F(QueryServerTest, ShouldServeConcurrentClients)
+{
+    // Arrange
+    constexpr size_t kClients = 8;
+    constexpr size_t kRequests = 200;
+
+    std::string requests;
+
+    for (size_t request = 0; request < kRequests; ++request)
+    {
+        requests += "o1=46 and o2=70\n";
+    }
+
+    std::string expected;
+
+    for (size_t request = 0; request < kRequests; ++request)
+    {
+        expected += "46.70.2.2\n46.70.1.1\n\n";
+    }
+
+    std::vector<std::string> responses(kClients);
+    std::vector<std::thread> clients;
+
+    // Act
+    for (size_t client = 0; client < kClients; ++client)
+    {
+        clients.emplace_back([this, &requests, &responses, client]
+                             { responses[client] = Exchange(requests); });
+    }
+
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+
+    // Assert
+    for (const auto& response : responses)
+    {
+        EXPECT_EQ(response, expected);
+    }
+}
+
+TEST_F(QueryServerTest, ShouldAnswerFromNewListAfterReload)
+{
+    // Arrange
+    server_->Reload({IPv4(46, 1, 1, 1)});
+
+    // Act
+    const auto response = Exchange("count o1=46\n");
+
+    // Assert
+    EXPECT_EQ(response, "1\n\n");
+}
+
+TEST_F(QueryServerTest, ShouldCloseConnectionWhenRequestIsTooLong)
+{
+    // Arrange
+    constexpr size_t kLength = size_t{1} << 20;
+
+    // Act
+    const auto response = Exchange(std::string(kLength, 'x'));
+
+    // Assert
+    EXPECT_EQ(response, "error: request too long\n\n");
+}
+
+TEST_F(QueryServerTest, ShouldAnswerErrorWhenQueryIsNestedTooDeeply)
+{
+    // Arrange
+    constexpr size_t kDepth = 30000;
+
+    // Act
+    const auto response =
+        Exchange(std::string(kDepth, '(') + "o1=1\ncount o1=46\n");
+
+    // Assert
+    EXPECT_EQ(response.rfind("error: ", 0), 0);
+    EXPECT_EQ(response.substr(response.find("\n\n") + 2), "2\n\n");
+}
+
+TEST(QueryServerConstructionTest, ShouldThrowWhenPathIsTooLong)
+{
+    // Act & Assert
+    EXPECT_THROW(QueryServer(std::string(sizeof(sockaddr_un::sun_path), 'x'),
+                             {}),
+                 std::invalid_argument);
+}
+
+}  // namespace
@@ -0,0 +1,311 @@
+#include "snapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace ip
+{
+
+namespace
+{
+
+static_assert(sizeof(IPv4) == sizeof(uint32_t) &&
+                  std::is_standard_layout_v<IPv4>,
+              "Raw snapshots are viewed as packed 32-bit addresses");
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr bool kLittleEndianHost = true;
+#else
+constexpr bool kLittleEndianHost = false;
+#endif
+
+constexpr std::array<char, 4> kMagic{'I', 'P', 'S', 'N'};
+constexpr uint16_t kVersion = 1;
+constexpr uint32_t kSortedFlag = 1;
+
+// magic, version, encoding, flags, reserved, count, payload size, checksum.
+constexpr size_t kHeaderSize = 40;
+constexpr size_t kVersionOffset = 4;
+constexpr size_t kEncodingOffset = 6;
+constexpr size_t kFlagsOffset = 8;
+constexpr size_t kCountOffset = 16;
+constexpr size_t kPayloadSizeOffset = 24;
+constexpr size_t kChecksumOffset = 32;
+
+constexpr unsigned kByteBits = std::numeric_limits<uint8_t>::digits;
+constexpr uint8_t kVarintPayloadMask = 0x7F;
+constexpr uint8_t kVarintContinuation = 0x80;
+constexpr unsigned kVarintPayloadBits = 7;
+
+constexpr uint64_t kFnvOffsetBasis = 0xCBF29CE484222325;
+constexpr uint64_t kFnvPrime = 0x100000001B3;
+
+template <typename T>
+void StoreLittleEndian(T value, char* out) noexcept
+{
+    for (size_t byte = 0; byte < sizeof(T); ++byte)
+    {
+        out[byte] = static_cast<char>(value >> (byte * kByteBits));
+    }
+}
+
+template <typename T>
+T LoadLittleEndian(const char* in) noexcept
+{
+    T value = 0;
+
+    for (size_t byte = 0; byte < sizeof(T); ++byte)
+    {
+        value |= static_cast<T>(static_cast<T>(static_cast<uint8_t>(in[byte]))
+                                << (byte * kByteBits));
+    }
+
+    return value;
+}
+
+// FNV-1a over 64-bit little-endian words rather than bytes, to keep up with
+// the speed the payload is paged in.
+uint64_t Checksum(const char* data, size_t size) noexcept
+{
+    uint64_t hash = kFnvOffsetBasis;
+    size_t offset = 0;
+
+    for (; size - offset >= sizeof(uint64_t); offset += sizeof(uint64_t))
+    {
+        hash = (hash ^ LoadLittleEndian<uint64_t>(data + offset)) * kFnvPrime;
+    }
+
+    if (offset != size)
+    {
+        std::array<char, sizeof(uint64_t)> tail{};
+        std::memcpy(tail.data(), data + offset, size - offset);
+        hash = (hash ^ LoadLittleEndian<uint64_t>(tail.data())) * kFnvPrime;
+    }
+
+    return hash;
+}
+
+std::vector<char> EncodeRaw(IpListView ips)
+{
+    std::vector<char> payload(ips.size() * sizeof(uint32_t));
+
+    for (size_t index = 0; index < ips.size(); ++index)
+    {
+        StoreLittleEndian(ips[index].ToUint32(),
+                          payload.data() + index * sizeof(uint32_t));
+    }
+
+    return payload;
+}
+
+// Deltas are taken from the previous address, starting from the largest
+// one, and are never negative in a descending list.
+std::vector<char> EncodeDeltaVarint(IpListView ips)
+{
+    std::vector<char> payload;
+    payload.reserve(ips.size() * 2);
+
+    uint32_t previous = std::numeric_limits<uint32_t>::max();
+
+    for (const auto& ip : ips)
+    {
+        uint32_t delta = previous - ip.ToUint32();
+        previous = ip.ToUint32();
+
+        while (delta > kVarintPayloadMask)
+        {
+            payload.push_back(static_cast<char>(
+                (delta & kVarintPayloadMask) | kVarintContinuation));
+            delta >>= kVarintPayloadBits;
+        }
+
+        payload.push_back(static_cast<char>(delta));
+    }
+
+    return payload;
+}
+
+[[noreturn]] void ThrowCorrupt(const std::string& path)
+{
+    throw std::runtime_error{"Corrupt snapshot " + path};
+}
+
+IpList DecodeRaw(const char* first, size_t count)
+{
+    IpList ips(count);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        ips[index] = IPv4::FromUint32(
+            LoadLittleEndian<uint32_t>(first + index * sizeof(uint32_t)));
+    }
+
+    return ips;
+}
+
+IpList DecodeDeltaVarint(const char* first, const char* last, size_t count,
+                         const std::string& path)
+{
+    IpList ips;
+    ips.reserve(std::min(count, static_cast<size_t>(last - first)));
+
+    uint32_t previous = std::numeric_limits<uint32_t>::max();
+
+    while (first != last)
+    {
+        uint32_t delta = 0;
+        unsigned shift = 0;
+        uint8_t byte = 0;
+
+        do
+        {
+            if (first == last || shift >= sizeof(uint32_t) * kByteBits)
+            {
+                ThrowCorrupt(path);
+            }
+
+            byte = static_cast<uint8_t>(*first++);
+            delta |= static_cast<uint32_t>(byte & kVarintPayloadMask) << shift;
+            shift += kVarintPayloadBits;
+        } while ((byte & kVarintContinuation) != 0);
+
+        previous -= delta;
+        ips.push_back(IPv4::FromUint32(previous));
+    }
+
+    if (ips.size() != count)
+    {
+        ThrowCorrupt(path);
+    }
+
+    return ips;
+}
+
+}  // namespace
+
+void WriteSnapshot(const std::string& path, IpListView ips,
+                   SnapshotEncoding encoding)
+{
+    const bool sorted =
+        std::is_sorted(ips.begin(), ips.end(), std::greater<IPv4>{});
+
+    if (encoding == SnapshotEncoding::kDeltaVarint && !sorted)
+    {
+        throw std::invalid_argument{
+            "Delta encoding needs reverse lexicographically sorted addresses"};
+    }
+
+    const auto payload = encoding == SnapshotEncoding::kRaw
+                             ? EncodeRaw(ips)
+                             : EncodeDeltaVarint(ips);
+
+    std::array<char, kHeaderSize> header{};
+    std::copy(kMagic.cbegin(), kMagic.cend(), header.begin());
+    StoreLittleEndian(kVersion, header.data() + kVersionOffset);
+    StoreLittleEndian(static_cast<uint16_t>(encoding),
+                      header.data() + kEncodingOffset);
+    StoreLittleEndian(sorted ? kSortedFlag : uint32_t{0},
+                      header.data() + kFlagsOffset);
+    StoreLittleEndian(static_cast<uint64_t>(ips.size()),
+                      header.data() + kCountOffset);
+    StoreLittleEndian(static_cast<uint64_t>(payload.size()),
+                      header.data() + kPayloadSizeOffset);
+    StoreLittleEndian(Checksum(payload.data(), payload.size()),
+                      header.data() + kChecksumOffset);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    file.close();
+
+    if (!file)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to write " + path);
+    }
+}
+
+Snapshot::Snapshot(const std::string& path) : file_{path}
+{
+    const auto bytes = file_.View();
+
+    if (bytes.size() < kHeaderSize ||
+        !std::equal(kMagic.cbegin(), kMagic.cend(), bytes.data()))
+    {
+        throw std::runtime_error{"Not a snapshot " + path};
+    }
+
+    if (LoadLittleEndian<uint16_t>(bytes.data() + kVersionOffset) != kVersion)
+    {
+        throw std::runtime_error{"Unsupported snapshot version " + path};
+    }
+
+    const auto encoding =
+        LoadLittleEndian<uint16_t>(bytes.data() + kEncodingOffset);
+    const auto count = LoadLittleEndian<uint64_t>(bytes.data() + kCountOffset);
+    const auto payload_size =
+        LoadLittleEndian<uint64_t>(bytes.data() + kPayloadSizeOffset);
+    const char* const payload = bytes.data() + kHeaderSize;
+
+    if (payload_size != bytes.size() - kHeaderSize ||
+        LoadLittleEndian<uint64_t>(bytes.data() + kChecksumOffset) !=
+            Checksum(payload, payload_size))
+    {
+        ThrowCorrupt(path);
+    }
+
+    sorted_ = (LoadLittleEndian<uint32_t>(bytes.data() + kFlagsOffset) &
+               kSortedFlag) != 0;
+
+    switch (static_cast<SnapshotEncoding>(encoding))
+    {
+        case SnapshotEncoding::kRaw:
+            if (payload_size % sizeof(uint32_t) != 0 ||
+                payload_size / sizeof(uint32_t) != count)
+            {
+                ThrowCorrupt(path);
+            }
+
+            encoding_ = SnapshotEncoding::kRaw;
+
+            if constexpr (kLittleEndianHost)
+            {
+                // The mapping is page aligned and the header keeps the
+                // payload aligned for 32-bit loads.
+                view_ = IpListView{reinterpret_cast<const IPv4*>(payload),
+                                   count};
+
+                return;
+            }
+
+            decoded_ = DecodeRaw(payload, count);
+            break;
+        case SnapshotEncoding::kDeltaVarint:
+            encoding_ = SnapshotEncoding::kDeltaVarint;
+            decoded_ = DecodeDeltaVarint(payload, payload + payload_size,
+                                         count, path);
+            break;
+        default:
+            throw std::runtime_error{"Unsupported snapshot encoding " + path};
+    }
+
+    view_ = decoded_;
+}
+
+IpListView Snapshot::View() const noexcept { return view_; }
+
+bool Snapshot::IsSorted() const noexcept { return sorted_; }
+
+SnapshotEncoding Snapshot::Encoding() const noexcept { return encoding_; }
+
+}  // namespace ip
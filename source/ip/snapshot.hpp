@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "ipv4.hpp"
+#include "mapped_file.hpp"
+
+namespace ip
+{
+
+enum class SnapshotEncoding : uint16_t
+{
+    // Packed little-endian uint32 values, mapped back without decoding.
+    kRaw = 0,
+    // Differences between neighbours of a list sorted by
+    // SortReverseLexicographical, as LEB128 varints. Smaller, but decoded on
+    // load.
+    kDeltaVarint = 1
+};
+
+// Writes `ips` to `path` in the versioned binary snapshot format: a header
+// with the count, sort state and payload checksum followed by the encoded
+// addresses. Throws std::invalid_argument when delta encoding is asked for
+// an unsorted list and std::system_error when the file cannot be written.
+void WriteSnapshot(const std::string& path, IpListView ips,
+                   SnapshotEncoding encoding = SnapshotEncoding::kRaw);
+
+// A snapshot file mapped into memory. Raw snapshots are viewed in place on
+// little-endian hosts, so loading costs little more than paging the file in.
+class Snapshot final
+{
+   public:
+    // Throws std::system_error when the file cannot be mapped and
+    // std::runtime_error when it is not a valid snapshot.
+    explicit Snapshot(const std::string& path);
+
+    IpListView View() const noexcept;
+
+    // Whether the addresses are in SortReverseLexicographical order.
+    bool IsSorted() const noexcept;
+
+    SnapshotEncoding Encoding() const noexcept;
+
+   private:
+    MappedFile file_;
+    IpList decoded_;
+    IpListView view_;
+    bool sorted_{false};
+    SnapshotEncoding encoding_{SnapshotEncoding::kRaw};
+};
+
+}  // namespace ip
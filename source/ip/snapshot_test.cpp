@@ -0,0 +1,149 @@
+#include "snapshot.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "utils.hpp"
+
+namespace
+{
+
+using ip::IPv4;
+using ip::IpList;
+using ip::Snapshot;
+using ip::SnapshotEncoding;
+using ip::WriteSnapshot;
+
+IpList RandomIps(size_t count)
+{
+    std::mt19937 engine{7};
+    IpList ips;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        ips.emplace_back(IPv4::FromUint32(static_cast<uint32_t>(engine())));
+    }
+
+    return ips;
+}
+
+class SnapshotTest : public ::testing::TestWithParam<SnapshotEncoding>
+{
+   protected:
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    void Corrupt(std::streamoff offset)
+    {
+        std::fstream file{path_,
+                          std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(offset);
+        file.put('\xFF');
+    }
+
+    std::string path_{::testing::TempDir() + "snapshot_test.ipsn"};
+};
+
+TEST_P(SnapshotTest, ShouldLoadWrittenAddressesWhenListIsSorted)
+{
+    // Arrange
+    auto ips = RandomIps(10000);
+    ip::SortReverseLexicographical(ips);
+    WriteSnapshot(path_, ips, GetParam());
+
+    // Act
+    const Snapshot snapshot{path_};
+
+    // Assert
+    EXPECT_TRUE(snapshot.IsSorted());
+    EXPECT_EQ(snapshot.Encoding(), GetParam());
+    EXPECT_EQ(IpList(snapshot.View().begin(), snapshot.View().end()), ips);
+}
+
+TEST_P(SnapshotTest, ShouldLoadEmptyListWhenNothingWasWritten)
+{
+    // Arrange
+    WriteSnapshot(path_, {}, GetParam());
+
+    // Act
+    const Snapshot snapshot{path_};
+
+    // Assert
+    EXPECT_TRUE(snapshot.View().empty());
+}
+
+TEST_P(SnapshotTest, ShouldThrowWhenPayloadIsCorrupt)
+{
+    // Arrange
+    auto ips = RandomIps(100);
+    ip::SortReverseLexicographical(ips);
+    WriteSnapshot(path_, ips, GetParam());
+    Corrupt(50);
+
+    // Act & Assert
+    EXPECT_THROW(Snapshot{path_}, std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(Encodings, SnapshotTest,
+                         ::testing::Values(SnapshotEncoding::kRaw,
+                                           SnapshotEncoding::kDeltaVarint));
+
+class SnapshotFormatTest : public SnapshotTest
+{
+};
+
+TEST_F(SnapshotFormatTest, ShouldKeepInputOrderWhenRawListIsUnsorted)
+{
+    // Arrange
+    const IpList ips{IPv4(1, 2, 3, 4), IPv4(200, 0, 0, 1), IPv4(0, 0, 0, 0)};
+    WriteSnapshot(path_, ips);
+
+    // Act
+    const Snapshot snapshot{path_};
+
+    // Assert
+    EXPECT_FALSE(snapshot.IsSorted());
+    EXPECT_EQ(IpList(snapshot.View().begin(), snapshot.View().end()), ips);
+}
+
+TEST_F(SnapshotFormatTest, ShouldStoreLittleEndianValuesAfterHeader)
+{
+    // Arrange
+    constexpr size_t kHeaderSize = 40;
+    WriteSnapshot(path_, IpList{IPv4(1, 2, 3, 4)});
+
+    // Act
+    std::ifstream file{path_, std::ios::binary};
+    const std::string bytes{std::istreambuf_iterator<char>{file}, {}};
+
+    // Assert
+    ASSERT_EQ(bytes.size(), kHeaderSize + 4);
+    EXPECT_EQ(bytes.substr(0, 4), "IPSN");
+    EXPECT_EQ(bytes.substr(kHeaderSize), "\x04\x03\x02\x01");
+}
+
+TEST_F(SnapshotFormatTest, ShouldThrowWhenDeltaEncodingUnsortedList)
+{
+    // Arrange
+    const IpList ips{IPv4(1, 2, 3, 4), IPv4(200, 0, 0, 1)};
+
+    // Act & Assert
+    EXPECT_THROW(WriteSnapshot(path_, ips, SnapshotEncoding::kDeltaVarint),
+                 std::invalid_argument);
+}
+
+TEST_F(SnapshotFormatTest, ShouldThrowWhenFileIsNotSnapshot)
+{
+    // Arrange
+    std::ofstream{path_} << "1.2.3.4\t1\t2\n";
+
+    // Act & Assert
+    EXPECT_THROW(Snapshot{path_}, std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,197 @@
+#include "sorted_store.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+#include "arena.hpp"
+#include "stats.hpp"
+#include "utils.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+IpList MergeTwo(IpListView newer, IpListView older)
+{
+    IpList merged(newer.size() + older.size());
+
+    std::merge(older.begin(), older.end(), newer.begin(), newer.end(),
+               merged.begin(), std::greater<IPv4>());
+
+    return merged;
+}
+
+// Merges the lists pairwise, smallest first, so that large lists are
+// copied as few times as possible.
+IpList MergeAll(std::vector<IpList> lists)
+{
+    if (lists.empty())
+    {
+        return {};
+    }
+
+    const auto by_size = [](const IpList& left, const IpList& right)
+    { return left.size() > right.size(); };
+
+    std::make_heap(lists.begin(), lists.end(), by_size);
+
+    while (lists.size() > 1)
+    {
+        std::pop_heap(lists.begin(), lists.end(), by_size);
+        auto smallest = std::move(lists.back());
+        lists.pop_back();
+
+        std::pop_heap(lists.begin(), lists.end(), by_size);
+        lists.back() = MergeTwo(smallest, lists.back());
+        std::push_heap(lists.begin(), lists.end(), by_size);
+    }
+
+    return std::move(lists.front());
+}
+
+}  // namespace
+
+SortedStoreView::SortedStoreView(std::vector<Run> runs)
+    : runs_{std::make_shared<const std::vector<Run>>(std::move(runs))}
+{
+}
+
+const std::vector<SortedStoreView::Run>& SortedStoreView::Runs()
+    const noexcept
+{
+    static const std::vector<Run> kNoRuns;
+
+    return runs_ ? *runs_ : kNoRuns;
+}
+
+size_t SortedStoreView::Size() const noexcept
+{
+    return std::accumulate(Runs().cbegin(), Runs().cend(), size_t{0},
+                           [](size_t size, const Run& run)
+                           { return size + run->size(); });
+}
+
+IpList SortedStoreView::Find(const Query& query) const
+{
+    std::vector<IpList> matches;
+    matches.reserve(Runs().size());
+
+    for (const auto& run : Runs())
+    {
+        matches.push_back(query.Run(*run, true));
+    }
+
+    return MergeAll(std::move(matches));
+}
+
+size_t SortedStoreView::Count(const Query& query) const
+{
+    // Sorted-range matches are counted as slices, without a copy.
+    IpArena arena;
+    size_t count = 0;
+
+    for (const auto& run : Runs())
+    {
+        count += query.Run(*run, true, 1, arena).size();
+        arena.Reset();
+    }
+
+    return count;
+}
+
+IpList SortedStoreView::Merge() const
+{
+    std::vector<IpList> lists;
+    lists.reserve(Runs().size());
+
+    for (const auto& run : Runs())
+    {
+        lists.push_back(*run);
+    }
+
+    return MergeAll(std::move(lists));
+}
+
+SortedStore::SortedStore(IpList sorted_ips, size_t buffer_capacity)
+    : buffer_capacity_{std::max<size_t>(buffer_capacity, 1)}
+{
+    if (!sorted_ips.empty())
+    {
+        runs_.push_back(
+            std::make_shared<const IpList>(std::move(sorted_ips)));
+    }
+
+    buffer_.reserve(buffer_capacity_);
+    Publish(runs_);
+}
+
+void SortedStore::Append(IpListView ips)
+{
+    const auto* first = ips.begin();
+
+    while (first != ips.end())
+    {
+        const auto count = std::min(buffer_capacity_ - buffer_.size(),
+                                    static_cast<size_t>(ips.end() - first));
+
+        buffer_.insert(buffer_.end(), first, first + count);
+        first += count;
+
+        if (buffer_.size() == buffer_capacity_)
+        {
+            Flush();
+        }
+    }
+}
+
+void SortedStore::Flush()
+{
+    if (buffer_.empty())
+    {
+        return;
+    }
+
+    ScopedPhase phase{"append"};
+    phase.AddRowsIn(buffer_.size());
+
+    // Only the delta is sorted; it joins the runs as the newest one.
+    SortReverseLexicographical(buffer_);
+
+    auto run = std::make_shared<const IpList>(std::move(buffer_));
+    buffer_ = IpList{};
+    buffer_.reserve(buffer_capacity_);
+
+    // Merging leaves runs shared with published views untouched, so
+    // readers keep seeing the state they started with.
+    while (!runs_.empty() && runs_.back()->size() < kFanout * run->size())
+    {
+        run = std::make_shared<const IpList>(MergeTwo(*run, *runs_.back()));
+        runs_.pop_back();
+    }
+
+    runs_.push_back(std::move(run));
+    phase.AddRowsOut(runs_.back()->size());
+
+    Publish(runs_);
+}
+
+SortedStoreView SortedStore::View() const
+{
+    const std::lock_guard lock{view_mutex_};
+
+    return view_;
+}
+
+void SortedStore::Publish(std::vector<SortedStoreView::Run> runs)
+{
+    SortedStoreView view{std::move(runs)};
+
+    const std::lock_guard lock{view_mutex_};
+    view_ = std::move(view);
+}
+
+}  // namespace ip
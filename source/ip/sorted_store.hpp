@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ipv4.hpp"
+#include "query.hpp"
+
+namespace ip
+{
+
+// Immutable state of a SortedStore: its runs, each in
+// SortReverseLexicographical order. Views stay valid and unchanged while
+// the store keeps taking appends.
+class SortedStoreView final
+{
+   public:
+    using Run = std::shared_ptr<const IpList>;
+
+    SortedStoreView() = default;
+
+    explicit SortedStoreView(std::vector<Run> runs);
+
+    const std::vector<Run>& Runs() const noexcept;
+
+    size_t Size() const noexcept;
+
+    // Matches of every run merged into SortReverseLexicographical order.
+    // Range plans binary search each run instead of scanning.
+    IpList Find(const Query& query) const;
+
+    size_t Count(const Query& query) const;
+
+    // Every address merged into one sorted list.
+    IpList Merge() const;
+
+   private:
+    std::shared_ptr<const std::vector<Run>> runs_;
+};
+
+// Sorted address list taking appends without re-sorting what it holds.
+// Appended addresses are buffered; a full buffer is sorted on its own into
+// a new run, and runs are merged LSM-style so that each one is at least
+// kFanout times the size of the next newer one. The runs thus stay few
+// (logarithmic in the size) and every address is merged a logarithmic
+// number of times.
+//
+// Append and Flush may be called by one thread at a time; View may be
+// called from any thread concurrently with them.
+class SortedStore final
+{
+   public:
+    static constexpr size_t kDefaultBufferCapacity = 4096;
+    static constexpr size_t kFanout = 4;
+
+    // `sorted_ips` must be in SortReverseLexicographical order.
+    explicit SortedStore(IpList sorted_ips = {},
+                         size_t buffer_capacity = kDefaultBufferCapacity);
+
+    // Addresses become visible once their buffer is flushed.
+    void Append(IpListView ips);
+
+    void Flush();
+
+    // The runs as of the latest flush.
+    SortedStoreView View() const;
+
+   private:
+    void Publish(std::vector<SortedStoreView::Run> runs);
+
+    size_t buffer_capacity_;
+    IpList buffer_;
+    // Oldest and largest first; only the writer changes it.
+    std::vector<SortedStoreView::Run> runs_;
+
+    mutable std::mutex view_mutex_;
+    SortedStoreView view_;
+};
+
+}  // namespace ip
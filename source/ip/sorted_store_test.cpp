@@ -0,0 +1,196 @@
+#include "sorted_store.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <thread>
+
+#include "query.hpp"
+#include "utils.hpp"
+
+namespace
+{
+
+using ip::IpList;
+using ip::IPv4;
+using ip::Query;
+using ip::SortedStore;
+
+IpList MakeRandomList(size_t size, uint32_t seed)
+{
+    std::mt19937 engine{seed};
+    IpList ips(size);
+
+    for (auto& ip : ips)
+    {
+        ip = IPv4::FromUint32(static_cast<uint32_t>(engine()));
+    }
+
+    return ips;
+}
+
+MATCHER(IsSortedDescending, "")
+{
+    return std::is_sorted(arg.begin(), arg.end(), std::greater<IPv4>());
+}
+
+class SortedStoreTest : public ::testing::TestWithParam<size_t>
+{
+};
+
+TEST_P(SortedStoreTest, ShouldMatchFullSortWhenAppendingInBatches)
+{
+    // Arrange
+    constexpr size_t kInitialSize = 10000;
+    constexpr size_t kBatches = 50;
+    constexpr size_t kBatchSize = 777;
+
+    auto initial = MakeRandomList(kInitialSize, 1);
+    ip::SortReverseLexicographical(initial);
+
+    SortedStore store{initial, GetParam()};
+    IpList expected = initial;
+
+    // Act
+    for (uint32_t batch = 0; batch < kBatches; ++batch)
+    {
+        const auto ips = MakeRandomList(kBatchSize, batch + 2);
+
+        store.Append(ips);
+        expected.insert(expected.end(), ips.begin(), ips.end());
+    }
+
+    store.Flush();
+
+    // Assert
+    ip::SortReverseLexicographical(expected);
+    EXPECT_EQ(store.View().Merge(), expected);
+}
+
+TEST_P(SortedStoreTest, ShouldKeepEveryRunFanoutTimesLargerThanNextOne)
+{
+    // Arrange
+    constexpr size_t kSize = 100000;
+    SortedStore store{{}, GetParam()};
+
+    // Act
+    store.Append(MakeRandomList(kSize, 7));
+    store.Flush();
+
+    // Assert
+    const auto& runs = store.View().Runs();
+
+    for (size_t run = 0; run + 1 < runs.size(); ++run)
+    {
+        EXPECT_GE(runs[run]->size(),
+                  SortedStore::kFanout * runs[run + 1]->size());
+    }
+
+    for (const auto& run : runs)
+    {
+        EXPECT_THAT(*run, IsSortedDescending());
+    }
+
+    EXPECT_EQ(store.View().Size(), kSize);
+}
+
+INSTANTIATE_TEST_SUITE_P(BufferCapacities, SortedStoreTest,
+                         ::testing::Values(1, 64, 4096, 1000000));
+
+TEST(SortedStoreViewTest, ShouldStayUnchangedWhenStoreTakesAppends)
+{
+    // Arrange
+    constexpr size_t kBufferCapacity = 2;
+    SortedStore store{{IPv4(10, 0, 0, 1)}, kBufferCapacity};
+
+    const auto before = store.View();
+
+    // Act
+    store.Append(IpList{IPv4(1, 1, 1, 1), IPv4(46, 70, 0, 1)});
+    store.Append(IpList{IPv4(46, 1, 0, 1)});
+
+    // Assert
+    EXPECT_THAT(before.Merge(), ::testing::ElementsAre(IPv4(10, 0, 0, 1)));
+    EXPECT_THAT(store.View().Merge(),
+                ::testing::ElementsAre(IPv4(46, 70, 0, 1), IPv4(10, 0, 0, 1),
+                                       IPv4(1, 1, 1, 1)));
+}
+
+TEST(SortedStoreViewTest, ShouldMatchQueryOverMergedList)
+{
+    // Arrange
+    constexpr size_t kSize = 50000;
+    constexpr size_t kBufferCapacity = 1000;
+
+    SortedStore store{{}, kBufferCapacity};
+    store.Append(MakeRandomList(kSize, 11));
+    store.Flush();
+
+    const auto view = store.View();
+    const auto merged = view.Merge();
+
+    for (const auto text : {"o1=46", "cidr 10.0.0.0/8 or o1=200", "any=46",
+                            "not o2=7"})
+    {
+        const auto query = Query::Parse(text);
+
+        // Act
+        const auto found = view.Find(query);
+        const auto count = view.Count(query);
+
+        // Assert
+        const auto expected = query.Run(merged, true);
+        EXPECT_EQ(found, expected) << text;
+        EXPECT_EQ(count, expected.size()) << text;
+    }
+}
+
+TEST(SortedStoreViewTest, ShouldSeeConsistentRunsWhileWriterAppends)
+{
+    // Arrange
+    // Every flush takes a full buffer, the final one included.
+    constexpr size_t kBatches = 200;
+    constexpr size_t kBatchSize = 128;
+    constexpr size_t kBufferCapacity = 256;
+
+    SortedStore store{{}, kBufferCapacity};
+    std::atomic<bool> done{false};
+
+    std::thread writer{[&store, &done]
+                       {
+                           for (uint32_t batch = 0; batch < kBatches; ++batch)
+                           {
+                               store.Append(MakeRandomList(kBatchSize, batch));
+                           }
+
+                           store.Flush();
+                           done = true;
+                       }};
+
+    // Act & Assert
+    size_t last_size = 0;
+
+    while (!done)
+    {
+        const auto view = store.View();
+
+        EXPECT_GE(view.Size(), last_size);
+        EXPECT_EQ(view.Size() % kBufferCapacity, 0);
+        last_size = view.Size();
+
+        for (const auto& run : view.Runs())
+        {
+            EXPECT_THAT(*run, IsSortedDescending());
+        }
+    }
+
+    writer.join();
+
+    EXPECT_EQ(store.View().Size(), kBatches * kBatchSize);
+}
+
+}  // namespace
@@ -0,0 +1,190 @@
+#include "stats.hpp"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define IP_STATS_HAVE_TSC 1
+#endif
+
+namespace ip
+{
+
+namespace
+{
+
+constexpr uint64_t kNanosecondsPerSecond = 1000000000;
+constexpr uint64_t kBytesPerKibibyte = 1024;
+
+std::atomic<bool>& EnabledFlag() noexcept
+{
+    static std::atomic<bool> enabled{std::getenv("IP_FILTER_STATS") !=
+                                     nullptr};
+
+    return enabled;
+}
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<PhaseTotals> phases;
+};
+
+Registry& GetRegistry()
+{
+    static Registry registry;
+
+    return registry;
+}
+
+uint64_t CpuTimeNs() noexcept
+{
+    timespec time{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+
+    return static_cast<uint64_t>(time.tv_sec) * kNanosecondsPerSecond +
+           static_cast<uint64_t>(time.tv_nsec);
+}
+
+uint64_t Cycles() noexcept
+{
+#ifdef IP_STATS_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+uint64_t PeakRssBytes() noexcept
+{
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+
+    // Linux reports ru_maxrss in kibibytes.
+    return static_cast<uint64_t>(usage.ru_maxrss) * kBytesPerKibibyte;
+}
+
+}  // namespace
+
+bool Stats::Enabled() noexcept
+{
+    return EnabledFlag().load(std::memory_order_relaxed);
+}
+
+void Stats::Enable(bool enabled) noexcept
+{
+    EnabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+void Stats::Record(const char* name, uint64_t wall_ns, uint64_t cpu_ns,
+                   uint64_t cycles, const PhaseCounters& counters)
+{
+    const auto peak_rss_bytes = PeakRssBytes();
+
+    auto& registry = GetRegistry();
+    const std::lock_guard lock{registry.mutex};
+
+    auto phase = std::find_if(registry.phases.begin(), registry.phases.end(),
+                              [name](const PhaseTotals& totals)
+                              { return totals.name == name; });
+
+    if (phase == registry.phases.end())
+    {
+        phase = registry.phases.insert(phase, PhaseTotals{});
+        phase->name = name;
+    }
+
+    ++phase->calls;
+    phase->wall_ns += wall_ns;
+    phase->cpu_ns += cpu_ns;
+    phase->cycles += cycles;
+    phase->counters.rows_in += counters.rows_in;
+    phase->counters.rows_out += counters.rows_out;
+    phase->counters.malformed += counters.malformed;
+    phase->counters.bytes_in += counters.bytes_in;
+    phase->counters.bytes_out += counters.bytes_out;
+    phase->peak_rss_bytes = std::max(phase->peak_rss_bytes, peak_rss_bytes);
+}
+
+std::vector<PhaseTotals> Stats::Phases()
+{
+    auto& registry = GetRegistry();
+    const std::lock_guard lock{registry.mutex};
+
+    return registry.phases;
+}
+
+void Stats::Reset()
+{
+    auto& registry = GetRegistry();
+    const std::lock_guard lock{registry.mutex};
+
+    registry.phases.clear();
+}
+
+void Stats::WriteJson(std::ostream& output)
+{
+    // Phase names are identifiers from the code, so they need no escaping.
+    output << R"({"phases":[)";
+
+    const auto phases = Phases();
+
+    for (size_t index = 0; index < phases.size(); ++index)
+    {
+        const auto& phase = phases[index];
+
+        output << (index == 0 ? "" : ",") << R"({"name":")" << phase.name
+               << R"(","calls":)" << phase.calls << R"(,"wall_ns":)"
+               << phase.wall_ns << R"(,"cpu_ns":)" << phase.cpu_ns
+               << R"(,"cycles":)" << phase.cycles << R"(,"rows_in":)"
+               << phase.counters.rows_in << R"(,"rows_out":)"
+               << phase.counters.rows_out << R"(,"malformed":)"
+               << phase.counters.malformed << R"(,"bytes_in":)"
+               << phase.counters.bytes_in << R"(,"bytes_out":)"
+               << phase.counters.bytes_out << R"(,"peak_rss_bytes":)"
+               << phase.peak_rss_bytes << '}';
+    }
+
+    output << R"(],"peak_rss_bytes":)" << PeakRssBytes() << "}\n";
+}
+
+ScopedPhase::ScopedPhase(const char* name) noexcept
+    : name_{name}, enabled_{Stats::Enabled()}
+{
+    if (enabled_)
+    {
+        wall_start_ = std::chrono::steady_clock::now();
+        cpu_start_ns_ = CpuTimeNs();
+        cycles_start_ = Cycles();
+    }
+}
+
+ScopedPhase::~ScopedPhase()
+{
+    if (!enabled_)
+    {
+        return;
+    }
+
+    const auto wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wall_start_);
+
+    try
+    {
+        Stats::Record(name_, static_cast<uint64_t>(wall_ns.count()),
+                      CpuTimeNs() - cpu_start_ns_, Cycles() - cycles_start_,
+                      counters_);
+    }
+    catch (...)
+    {
+        // Losing a sample is better than terminating from a destructor.
+    }
+}
+
+}  // namespace ip
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ip
+{
+
+struct PhaseCounters
+{
+    uint64_t rows_in{0};
+    uint64_t rows_out{0};
+    uint64_t malformed{0};
+    uint64_t bytes_in{0};
+    uint64_t bytes_out{0};
+};
+
+struct PhaseTotals
+{
+    std::string name;
+    uint64_t calls{0};
+    uint64_t wall_ns{0};
+    uint64_t cpu_ns{0};
+    uint64_t cycles{0};
+    PhaseCounters counters;
+    uint64_t peak_rss_bytes{0};
+};
+
+// Opt-in process-wide instrumentation, enabled by Enable() or by setting the
+// IP_FILTER_STATS environment variable. Phases with the same name are summed.
+class Stats final
+{
+   public:
+    static bool Enabled() noexcept;
+
+    static void Enable(bool enabled) noexcept;
+
+    static void Record(const char* name, uint64_t wall_ns, uint64_t cpu_ns,
+                       uint64_t cycles, const PhaseCounters& counters);
+
+    static std::vector<PhaseTotals> Phases();
+
+    static void Reset();
+
+    // Writes {"phases": [...], "peak_rss_bytes": N} on a single line.
+    static void WriteJson(std::ostream& output);
+};
+
+// Measures its own lifetime as one call of the named phase. When the stats
+// are disabled it neither reads clocks nor records anything; the counters
+// are plain additions either way.
+class ScopedPhase final
+{
+   public:
+    explicit ScopedPhase(const char* name) noexcept;
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    ~ScopedPhase();
+
+    void AddRowsIn(uint64_t rows) noexcept { counters_.rows_in += rows; }
+    void AddRowsOut(uint64_t rows) noexcept { counters_.rows_out += rows; }
+    void AddMalformed(uint64_t rows) noexcept { counters_.malformed += rows; }
+    void AddBytesIn(uint64_t bytes) noexcept { counters_.bytes_in += bytes; }
+    void AddBytesOut(uint64_t bytes) noexcept { counters_.bytes_out += bytes; }
+
+   private:
+    const char* name_;
+    bool enabled_;
+    PhaseCounters counters_;
+    std::chrono::steady_clock::time_point wall_start_{};
+    uint64_t cpu_start_ns_{0};
+    uint64_t cycles_start_{0};
+};
+
+}  // namespace ip
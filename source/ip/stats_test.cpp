@@ -0,0 +1,157 @@
+#include "stats.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string_view>
+
+#include "filter.hpp"
+#include "utils.hpp"
+
+namespace
+{
+
+using namespace std::string_view_literals;
+
+using ip::IPv4;
+using ip::IpList;
+using ip::PhaseTotals;
+using ip::ScopedPhase;
+using ip::Stats;
+
+class StatsTest : public ::testing::Test
+{
+   protected:
+    void SetUp() override
+    {
+        Stats::Reset();
+        Stats::Enable(true);
+    }
+
+    void TearDown() override
+    {
+        Stats::Enable(false);
+        Stats::Reset();
+    }
+
+    static PhaseTotals Phase(std::string_view name)
+    {
+        for (const auto& phase : Stats::Phases())
+        {
+            if (phase.name == name)
+            {
+                return phase;
+            }
+        }
+
+        return {};
+    }
+};
+
+TEST_F(StatsTest, ShouldSumCallsWithSameName)
+{
+    // Act
+    for (int call = 0; call < 3; ++call)
+    {
+        ScopedPhase phase{"phase"};
+        phase.AddRowsIn(2);
+        phase.AddBytesOut(5);
+    }
+
+    // Assert
+    const auto phase = Phase("phase");
+    EXPECT_EQ(phase.calls, 3U);
+    EXPECT_EQ(phase.counters.rows_in, 6U);
+    EXPECT_EQ(phase.counters.bytes_out, 15U);
+    EXPECT_GT(phase.peak_rss_bytes, 0U);
+}
+
+TEST_F(StatsTest, ShouldRecordNothingWhenDisabled)
+{
+    // Arrange
+    Stats::Enable(false);
+
+    // Act
+    {
+        ScopedPhase phase{"phase"};
+        phase.AddRowsIn(1);
+    }
+
+    // Assert
+    EXPECT_THAT(Stats::Phases(), ::testing::IsEmpty());
+}
+
+TEST_F(StatsTest, ShouldCountMalformedLinesWhenReadingBuffer)
+{
+    // Arrange
+    constexpr auto kInput = "1.2.3.4\nbad\n\n  \n1.2.3\t4\n5.6.7.8"sv;
+
+    // Act
+    ip::BufferReader{kInput}.ReadFirstIpFromLines();
+
+    // Assert
+    const auto phase = Phase("reader");
+    EXPECT_EQ(phase.counters.rows_out, 2U);
+    EXPECT_EQ(phase.counters.malformed, 2U);
+    EXPECT_EQ(phase.counters.bytes_in, kInput.size());
+}
+
+TEST_F(StatsTest, ShouldCountMalformedLinesWhenReadingStream)
+{
+    // Arrange
+    std::istringstream input{"1.2.3.4\nbad\n1.2.3\t4\n5.6.7.8\n"};
+
+    // Act
+    ip::Reader{input}.ReadFirstIpFromLines();
+
+    // Assert
+    const auto phase = Phase("reader");
+    EXPECT_EQ(phase.counters.rows_out, 2U);
+    EXPECT_EQ(phase.counters.malformed, 2U);
+}
+
+TEST_F(StatsTest, ShouldCountRowsAndBytesWhenFilteringAndPrinting)
+{
+    // Arrange
+    const IpList ips{IPv4(46, 70, 1, 1), IPv4(1, 2, 3, 4), IPv4(46, 1, 1, 1)};
+    std::ostringstream output;
+    ip::Printer printer{output};
+
+    // Act
+    printer.Print(ip::Filter{ips}.FilterByOctetValue(46));
+
+    // Assert
+    const auto filter = Phase("filter");
+    EXPECT_EQ(filter.counters.rows_in, 3U);
+    EXPECT_EQ(filter.counters.rows_out, 2U);
+
+    const auto printer_phase = Phase("printer");
+    EXPECT_EQ(printer_phase.counters.rows_in, 2U);
+    EXPECT_EQ(printer_phase.counters.bytes_out, output.str().size());
+}
+
+TEST_F(StatsTest, ShouldWriteOneJsonObject)
+{
+    // Arrange
+    {
+        ScopedPhase phase{"phase"};
+        phase.AddMalformed(1);
+    }
+
+    std::ostringstream output;
+
+    // Act
+    Stats::WriteJson(output);
+
+    // Assert
+    EXPECT_THAT(output.str(),
+                ::testing::AllOf(
+                    ::testing::StartsWith(R"({"phases":[{"name":"phase",)"
+                                          R"("calls":1,"wall_ns":)"),
+                    ::testing::HasSubstr(R"("malformed":1,)"),
+                    ::testing::HasSubstr(R"(],"peak_rss_bytes":)"),
+                    ::testing::EndsWith("}\n")));
+}
+
+}  // namespace
@@ -0,0 +1,383 @@
+#include "stream.hpp"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <system_error>
+#include <utility>
+
+#include "bounded_queue.hpp"
+#include "parallel.hpp"
+#include "utils.hpp"
+
+namespace ip
+{
+
+namespace
+{
+
+[[noreturn]] void ThrowSystemError(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Cuts the input into blocks ending at a line boundary, so every block can be
+// parsed on its own. A line longer than a block is kept whole.
+void ReadBlocks(std::istream& input, size_t block_size,
+                BoundedQueue<std::string>& blocks)
+{
+    std::string carry;
+
+    while (true)
+    {
+        std::string block = std::move(carry);
+        const auto carried = block.size();
+
+        block.resize(carried + block_size);
+        input.read(block.data() + static_cast<std::ptrdiff_t>(carried),
+                   static_cast<std::streamsize>(block_size));
+        block.resize(carried + static_cast<size_t>(input.gcount()));
+
+        if (!input)
+        {
+            if (!block.empty())
+            {
+                blocks.Push(std::move(block));
+            }
+
+            return;
+        }
+
+        const auto line_end = block.rfind('\n');
+
+        if (line_end == std::string::npos)
+        {
+            carry = std::move(block);
+            continue;
+        }
+
+        carry.assign(block, line_end + 1);
+        block.resize(line_end + 1);
+
+        if (!blocks.Push(std::move(block)))
+        {
+            return;
+        }
+    }
+}
+
+template <typename In, typename Out, typename Transform>
+void Transfer(BoundedQueue<In>& from, BoundedQueue<Out>& to,
+              const Transform& transform)
+{
+    while (auto item = from.Pop())
+    {
+        if (!to.Push(transform(std::move(*item))))
+        {
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+void StreamFilter(std::istream& input, const Filter::Predicate& accept,
+                  const BatchConsumer& emit, const StreamOptions& options)
+{
+    BoundedQueue<std::string> blocks{options.queue_depth};
+    BoundedQueue<IpList> parsed{options.queue_depth};
+    BoundedQueue<IpList> accepted{options.queue_depth};
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    // A failing stage closes every queue, which unblocks and stops the others.
+    const auto close_all = [&blocks, &parsed, &accepted]
+    {
+        blocks.Close();
+        parsed.Close();
+        accepted.Close();
+    };
+
+    const auto run_stage = [&error_mutex, &error, &close_all](
+                               const auto& stage, auto& output)
+    {
+        try
+        {
+            stage();
+            output.Close();
+        }
+        catch (...)
+        {
+            const std::lock_guard lock{error_mutex};
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            close_all();
+        }
+    };
+
+    ThreadGroup threads;
+
+    try
+    {
+        threads.Start(
+            [&]
+            {
+                run_stage(
+                    [&] { ReadBlocks(input, options.block_size, blocks); },
+                    blocks);
+            });
+
+        threads.Start(
+            [&]
+            {
+                run_stage(
+                    [&]
+                    {
+                        Transfer(blocks, parsed,
+                                 [](const std::string& block)
+                                 {
+                                     return BufferReader{block}
+                                         .ReadFirstIpFromLines();
+                                 });
+                    },
+                    parsed);
+            });
+
+        threads.Start(
+            [&]
+            {
+                run_stage(
+                    [&]
+                    {
+                        Transfer(parsed, accepted,
+                                 [&accept](IpList ips)
+                                 {
+                                     ips.erase(std::remove_if(
+                                                   ips.begin(), ips.end(),
+                                                   [&accept](const IPv4& ip)
+                                                   { return !accept(ip); }),
+                                               ips.end());
+
+                                     return ips;
+                                 });
+                    },
+                    accepted);
+            });
+    }
+    catch (...)
+    {
+        // The stages already started stop at the closed queues.
+        close_all();
+        threads.Join();
+        throw;
+    }
+
+    run_stage(
+        [&]
+        {
+            while (auto batch = accepted.Pop())
+            {
+                if (!batch->empty())
+                {
+                    emit(*batch);
+                }
+            }
+        },
+        accepted);
+
+    threads.Join();
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void ExternalSorter::FileCloser::operator()(std::FILE* file) const noexcept
+{
+    std::fclose(file);
+}
+
+ExternalSorter::ExternalSorter(size_t run_capacity, std::string temp_directory)
+    : run_capacity_{std::max<size_t>(run_capacity, 1)},
+      temp_directory_{std::move(temp_directory)}
+{
+}
+
+void ExternalSorter::Add(IpListView ips)
+{
+    for (const auto* first = ips.begin(); first != ips.end();)
+    {
+        const auto count =
+            std::min<size_t>(run_capacity_ - run_.size(),
+                             static_cast<size_t>(ips.end() - first));
+
+        run_.insert(run_.end(), first, first + count);
+        first += count;
+
+        if (run_.size() == run_capacity_)
+        {
+            Spill();
+        }
+    }
+}
+
+void ExternalSorter::Finish(const BatchConsumer& emit)
+{
+    if (runs_.empty())
+    {
+        SortReverseLexicographical(run_);
+
+        if (!run_.empty())
+        {
+            emit(run_);
+        }
+
+        run_ = IpList{};
+
+        return;
+    }
+
+    if (!run_.empty())
+    {
+        Spill();
+    }
+
+    run_ = IpList{};
+    Merge(emit);
+    runs_.clear();
+}
+
+size_t ExternalSorter::SpilledRuns() const noexcept { return runs_.size(); }
+
+std::string ExternalSorter::DefaultTempDirectory()
+{
+    return std::filesystem::temp_directory_path().string();
+}
+
+void ExternalSorter::Spill()
+{
+    SortReverseLexicographical(run_);
+
+    std::string path = temp_directory_ + "/ip_filter_run_XXXXXX";
+    const int fd = ::mkstemp(path.data());
+
+    if (fd < 0)
+    {
+        ThrowSystemError("Failed to create a run file in " + temp_directory_);
+    }
+
+    // The file has no name from now on and disappears once closed.
+    ::unlink(path.c_str());
+
+    RunFile file{::fdopen(fd, "w+b")};
+
+    if (!file)
+    {
+        ::close(fd);
+        ThrowSystemError("Failed to open a run file in " + temp_directory_);
+    }
+
+    if (std::fwrite(run_.data(), sizeof(IPv4), run_.size(), file.get()) !=
+            run_.size() ||
+        std::fflush(file.get()) != 0)
+    {
+        ThrowSystemError("Failed to write a run file in " + temp_directory_);
+    }
+
+    std::rewind(file.get());
+    runs_.emplace_back(std::move(file));
+    run_.clear();
+}
+
+void ExternalSorter::Merge(const BatchConsumer& emit)
+{
+    // Every run is read through its own buffer, so the merge needs
+    // runs * kMergeBufferSize addresses on top of the output batch.
+    constexpr size_t kMergeBufferSize = size_t{16} * 1024;
+
+    struct RunCursor
+    {
+        std::FILE* file;
+        IpList buffer;
+        size_t position;
+
+        bool Refill()
+        {
+            buffer.resize(kMergeBufferSize);
+            buffer.resize(std::fread(buffer.data(), sizeof(IPv4),
+                                     kMergeBufferSize, file));
+            position = 0;
+
+            return !buffer.empty();
+        }
+    };
+
+    std::vector<RunCursor> cursors;
+    cursors.reserve(runs_.size());
+
+    using Head = std::pair<IPv4, size_t>;
+    std::priority_queue<Head> heads;
+
+    for (size_t run = 0; run < runs_.size(); ++run)
+    {
+        cursors.push_back({runs_[run].get(), {}, 0});
+
+        if (cursors.back().Refill())
+        {
+            heads.emplace(cursors.back().buffer.front(), run);
+        }
+    }
+
+    IpList batch;
+    batch.reserve(kMergeBufferSize);
+
+    while (!heads.empty())
+    {
+        const auto run = heads.top().second;
+        auto& cursor = cursors[run];
+
+        batch.push_back(heads.top().first);
+        heads.pop();
+
+        if (++cursor.position < cursor.buffer.size() || cursor.Refill())
+        {
+            heads.emplace(cursor.buffer[cursor.position], run);
+        }
+
+        if (batch.size() == kMergeBufferSize)
+        {
+            emit(batch);
+            batch.clear();
+        }
+    }
+
+    for (const auto& cursor : cursors)
+    {
+        if (std::ferror(cursor.file) != 0)
+        {
+            ThrowSystemError("Failed to read a run file in " +
+                             temp_directory_);
+        }
+    }
+
+    if (!batch.empty())
+    {
+        emit(batch);
+    }
+}
+
+}  // namespace ip
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "filter.hpp"
+#include "ipv4.hpp"
+
+namespace ip
+{
+
+using BatchConsumer = std::function<void(IpListView)>;
+
+struct StreamOptions
+{
+    // Bytes of input text handed from the reader to the parser at once.
+    size_t block_size{size_t{1} << 20};
+    // Blocks in flight between two neighbouring stages.
+    size_t queue_depth{4};
+};
+
+// Reads lines from `input`, parses their first addresses like
+// Reader::ReadFirstIpFromLines, keeps the ones accepted by `accept` and hands
+// them to `emit` in input order. Reading, parsing and filtering run on their
+// own threads connected by bounded queues, `emit` runs on the calling thread,
+// so memory use does not depend on the input size.
+void StreamFilter(std::istream& input, const Filter::Predicate& accept,
+                  const BatchConsumer& emit, const StreamOptions& options = {});
+
+// Sorts any number of addresses in SortReverseLexicographical order with
+// bounded memory: every `run_capacity` added addresses are sorted and
+// spilled to an unnamed temporary file, and Finish merges the runs.
+class ExternalSorter final
+{
+   public:
+    explicit ExternalSorter(
+        size_t run_capacity,
+        std::string temp_directory = DefaultTempDirectory());
+
+    void Add(IpListView ips);
+
+    // Emits every added address in order, in batches. The sorter is empty
+    // afterwards.
+    void Finish(const BatchConsumer& emit);
+
+    size_t SpilledRuns() const noexcept;
+
+    static std::string DefaultTempDirectory();
+
+   private:
+    struct FileCloser
+    {
+        void operator()(std::FILE* file) const noexcept;
+    };
+
+    using RunFile = std::unique_ptr<std::FILE, FileCloser>;
+
+    void Spill();
+
+    void Merge(const BatchConsumer& emit);
+
+    size_t run_capacity_;
+    std::string temp_directory_;
+    IpList run_;
+    std::vector<RunFile> runs_;
+};
+
+}  // namespace ip
@@ -0,0 +1,180 @@
+#include "stream.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "utils.hpp"
+
+namespace
+{
+
+using ip::ExternalSorter;
+using ip::IPv4;
+using ip::IpList;
+using ip::IpListView;
+using ip::StreamFilter;
+using ip::StreamOptions;
+
+const auto kAcceptAll = [](const IPv4&) { return true; };
+
+IpList RandomIps(size_t count)
+{
+    std::mt19937 engine{1};
+    IpList ips;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        ips.emplace_back(IPv4::FromUint32(static_cast<uint32_t>(engine())));
+    }
+
+    return ips;
+}
+
+std::string ToLines(const IpList& ips)
+{
+    std::ostringstream text;
+
+    for (const auto& ip : ips)
+    {
+        text << ip << "\t1\t2\n";
+    }
+
+    return text.str();
+}
+
+IpList Collect(std::istream& input, const ip::Filter::Predicate& accept,
+               const StreamOptions& options)
+{
+    IpList result;
+
+    StreamFilter(input, accept,
+                 [&result](IpListView batch)
+                 { result.insert(result.end(), batch.begin(), batch.end()); },
+                 options);
+
+    return result;
+}
+
+TEST(StreamFilterTest, ShouldMatchReaderWhenBlocksSplitLines)
+{
+    // Arrange
+    std::istringstream input{
+        "1.2.3.4\tx\n\ninvalid\n46.70.1.1\ty\n  10.0.0.1\n5.6.7.8"};
+    std::istringstream expected_input{input.str()};
+    const auto expected = ip::Reader{expected_input}.ReadFirstIpFromLines();
+
+    // Act
+    const auto result = Collect(input, kAcceptAll, {7, 1});
+
+    // Assert
+    EXPECT_EQ(result, expected);
+}
+
+TEST(StreamFilterTest, ShouldKeepOnlyAcceptedIpsInInputOrder)
+{
+    // Arrange
+    const auto ips = RandomIps(10000);
+    std::istringstream input{ToLines(ips)};
+    IpList expected;
+    std::copy_if(ips.cbegin(), ips.cend(), std::back_inserter(expected),
+                 ip::OctetValuePredicate{46});
+
+    // Act
+    const auto result =
+        Collect(input, ip::OctetValuePredicate{46}, {4096, 2});
+
+    // Assert
+    EXPECT_EQ(result, expected);
+}
+
+TEST(StreamFilterTest, ShouldEmitNothingWhenInputIsEmpty)
+{
+    // Arrange
+    std::istringstream input;
+
+    // Act
+    const auto result = Collect(input, kAcceptAll, {});
+
+    // Assert
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(StreamFilterTest, ShouldRethrowWhenConsumerThrows)
+{
+    // Arrange
+    std::istringstream input{ToLines(RandomIps(10000))};
+
+    // Act & Assert
+    EXPECT_THROW(StreamFilter(
+                     input, kAcceptAll,
+                     [](IpListView) { throw std::runtime_error{"consumer"}; },
+                     {1024, 1}),
+                 std::runtime_error);
+}
+
+class ExternalSorterTest : public ::testing::TestWithParam<size_t>
+{
+   protected:
+    static IpList Sort(ExternalSorter& sorter)
+    {
+        IpList result;
+
+        sorter.Finish(
+            [&result](IpListView batch)
+            { result.insert(result.end(), batch.begin(), batch.end()); });
+
+        return result;
+    }
+};
+
+TEST_P(ExternalSorterTest, ShouldMatchInMemorySortForAnyRunCapacity)
+{
+    // Arrange
+    auto ips = RandomIps(5000);
+    ExternalSorter sorter{GetParam(), ::testing::TempDir()};
+    sorter.Add(IpListView{ips.data(), 1234});
+    sorter.Add(IpListView{ips.data() + 1234, ips.size() - 1234});
+    ip::SortReverseLexicographical(ips);
+
+    // Act
+    const auto result = Sort(sorter);
+
+    // Assert
+    EXPECT_EQ(result, ips);
+}
+
+INSTANTIATE_TEST_SUITE_P(RunCapacities, ExternalSorterTest,
+                         ::testing::Values(1, 7, 1000, 5000, 100000));
+
+TEST(ExternalSorterSpillTest, ShouldSpillOneRunPerFullCapacity)
+{
+    // Arrange
+    const auto ips = RandomIps(25);
+    ExternalSorter sorter{10, ::testing::TempDir()};
+
+    // Act
+    sorter.Add(ips);
+
+    // Assert
+    EXPECT_EQ(sorter.SpilledRuns(), 2U);
+}
+
+TEST(ExternalSorterSpillTest, ShouldEmitNothingWhenNothingWasAdded)
+{
+    // Arrange
+    ExternalSorter sorter{10, ::testing::TempDir()};
+    bool emitted = false;
+
+    // Act
+    sorter.Finish([&emitted](IpListView) { emitted = true; });
+
+    // Assert
+    EXPECT_FALSE(emitted);
+}
+
+}  // namespace
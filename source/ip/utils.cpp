@@ -1,21 +1,36 @@
 #include "utils.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <limits>
+#include <utility>
+
+#include "address_family.hpp"
+#include "lines.hpp"
+#include "parallel.hpp"
+#include "stats.hpp"
 
 namespace ip
 {
 
-Reader::Reader(std::istream& is) : input_{is} {}
+template <typename Address>
+BasicReader<Address>::BasicReader(std::istream& is) : input_{is}
+{
+}
 
-IpList Reader::ReadFirstIpFromLines()
+template <typename Address>
+std::vector<Address> BasicReader<Address>::ReadFirstIpFromLines()
 {
-    IpList ip_addresses;
+    ScopedPhase phase{"reader"};
+    std::vector<Address> ip_addresses;
 
     while (!input_.eof())
     {
-        if (IPv4 ip; !(input_ >> ip))
+        if (Address ip; !(input_ >> ip))
         {
+            // A failure at the end of the input is the empty last line.
+            phase.AddMalformed(input_.eof() ? 0 : 1);
             input_.clear();
         }
         else
@@ -26,22 +41,319 @@ IpList Reader::ReadFirstIpFromLines()
         input_.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     }
 
+    phase.AddRowsOut(ip_addresses.size());
+
     return ip_addresses;
 }
 
-Printer::Printer(std::ostream& os) : output_{os} {}
+namespace
+{
+
+constexpr size_t kMinBytesPerWorker = size_t{256} * 1024;
+constexpr size_t kRadixSortThreshold = 256;
+constexpr size_t kRadixBits = std::numeric_limits<uint8_t>::digits;
+constexpr size_t kRadixBuckets = size_t{1} << kRadixBits;
+constexpr uint32_t kRadixMask = kRadixBuckets - 1;
+constexpr size_t kRadixPasses = sizeof(uint32_t);
+
+using RadixCounts = std::array<size_t, kRadixBuckets>;
+
+size_t RadixDigit(const IPv4& ip, size_t pass) noexcept
+{
+    return (ip.ToUint32() >> (pass * kRadixBits)) & kRadixMask;
+}
 
-void Printer::Print(const IpList& ip_list)
+// LSD radix sort over the packed address, one byte per pass. Buckets are laid
+// out from the highest digit down, which yields descending order.
+void RadixSortDescending(IpList& ip_list)
 {
+    std::array<RadixCounts, kRadixPasses> counts{};
+
     for (const auto& ip : ip_list)
     {
-        output_ << ip << std::endl;
+        for (size_t pass = 0; pass < kRadixPasses; ++pass)
+        {
+            ++counts[pass][RadixDigit(ip, pass)];
+        }
+    }
+
+    IpList buffer(ip_list.size());
+
+    IpList* source = &ip_list;
+    IpList* target = &buffer;
+
+    for (size_t pass = 0; pass < kRadixPasses; ++pass)
+    {
+        const auto& count = counts[pass];
+
+        // Every address shares this byte, the pass would be an identity.
+        if (std::find(count.cbegin(), count.cend(), ip_list.size()) !=
+            count.cend())
+        {
+            continue;
+        }
+
+        RadixCounts offsets{};
+        size_t offset = 0;
+
+        for (size_t bucket = kRadixBuckets; bucket-- > 0;)
+        {
+            offsets[bucket] = offset;
+            offset += count[bucket];
+        }
+
+        for (const auto& ip : *source)
+        {
+            (*target)[offsets[RadixDigit(ip, pass)]++] = ip;
+        }
+
+        std::swap(source, target);
+    }
+
+    if (source != &ip_list)
+    {
+        ip_list.swap(buffer);
     }
 }
 
+// Runs read_lines(first, last, malformed) over the chunks of `input` and
+// returns the per-chunk results in line order. With more than one worker,
+// inputs large enough to be worth it are split on line boundaries and the
+// chunks are read concurrently.
+template <typename ReadLines>
+auto ReadChunks(std::string_view input, size_t workers,
+                const ReadLines& read_lines, ScopedPhase& phase)
+{
+    const char* const first = input.data();
+    const char* const last = first + input.size();
+
+    workers = std::max<size_t>(
+        std::min(workers, input.size() / kMinBytesPerWorker), 1);
+
+    // Every chunk boundary is moved forward past the next newline, so each
+    // line belongs to exactly one chunk.
+    std::vector<const char*> bounds(workers + 1, last);
+    bounds.front() = first;
+
+    for (size_t chunk = 1; chunk < workers; ++chunk)
+    {
+        const char* bound = std::max(first + input.size() * chunk / workers,
+                                     bounds[chunk - 1]);
+        const auto* line_end = static_cast<const char*>(
+            std::memchr(bound, '\n', static_cast<size_t>(last - bound)));
+
+        bounds[chunk] = line_end == nullptr ? last : line_end + 1;
+    }
+
+    std::vector<decltype(read_lines(first, last, std::declval<size_t&>()))>
+        parts(workers);
+    std::vector<size_t> malformed(workers);
+
+    ForEachChunk(workers, workers,
+                 [&bounds, &parts, &malformed, &read_lines](
+                     size_t chunk, [[maybe_unused]] size_t begin,
+                     [[maybe_unused]] size_t end)
+                 {
+                     parts[chunk] = read_lines(bounds[chunk],
+                                               bounds[chunk + 1],
+                                               malformed[chunk]);
+                 });
+
+    for (const auto count : malformed)
+    {
+        phase.AddMalformed(count);
+    }
+
+    return parts;
+}
+
+}  // namespace
+
+template <typename Address>
+BasicBufferReader<Address>::BasicBufferReader(std::string_view buffer,
+                                              size_t workers) noexcept
+    : input_{buffer}, workers_{std::max<size_t>(workers, 1)}
+{
+}
+
+template <typename Address>
+std::vector<Address> BasicBufferReader<Address>::ReadFirstIpFromLines() const
+{
+    ScopedPhase phase{"reader"};
+    phase.AddBytesIn(input_.size());
+
+    auto parts = ReadChunks(input_, workers_, ReadLines, phase);
+    auto ip_addresses = Concatenate(std::move(parts));
+
+    phase.AddRowsOut(ip_addresses.size());
+
+    return ip_addresses;
+}
+
+template <typename Address>
+std::vector<Address> BasicBufferReader<Address>::ReadLines(const char* first,
+                                                           const char* last,
+                                                           size_t& malformed)
+{
+    std::vector<Address> ip_addresses;
+
+    detail::ForEachLine(
+        first, last,
+        [&ip_addresses, &malformed](const char* text, const char* line_end)
+        {
+            if (Address ip; AddressFamily<Address>::Parse(text, line_end, ip))
+            {
+                ip_addresses.emplace_back(ip);
+            }
+            else if (text != line_end)
+            {
+                ++malformed;
+            }
+        });
+
+    return ip_addresses;
+}
+
+void IncrementalReader::Read(std::string_view block)
+{
+    lines_.Read(block, [this](std::string_view lines) { ReadLines(lines); });
+}
+
+IpList IncrementalReader::Finish()
+{
+    lines_.Finish([this](std::string_view line) { ReadLines(line); });
+
+    return std::move(ip_addresses_);
+}
+
+void IncrementalReader::ReadLines(std::string_view lines)
+{
+    const auto parsed = BufferReader{lines}.ReadFirstIpFromLines();
+
+    ip_addresses_.insert(ip_addresses_.end(), parsed.cbegin(), parsed.cend());
+}
+
+DualStackReader::DualStackReader(std::string_view buffer,
+                                 size_t workers) noexcept
+    : input_{buffer}, workers_{std::max<size_t>(workers, 1)}
+{
+}
+
+DualStackList DualStackReader::ReadFirstIpFromLines() const
+{
+    ScopedPhase phase{"reader"};
+    phase.AddBytesIn(input_.size());
+
+    auto parts = ReadChunks(input_, workers_, ReadLines, phase);
+
+    std::vector<IpList> ipv4_parts(parts.size());
+    std::vector<IPv6List> ipv6_parts(parts.size());
+
+    for (size_t chunk = 0; chunk < parts.size(); ++chunk)
+    {
+        ipv4_parts[chunk] = std::move(parts[chunk].ipv4);
+        ipv6_parts[chunk] = std::move(parts[chunk].ipv6);
+    }
+
+    DualStackList ip_addresses{Concatenate(std::move(ipv4_parts)),
+                               Concatenate(std::move(ipv6_parts))};
+
+    phase.AddRowsOut(ip_addresses.ipv4.size() + ip_addresses.ipv6.size());
+
+    return ip_addresses;
+}
+
+DualStackList DualStackReader::ReadLines(const char* first, const char* last,
+                                         size_t& malformed)
+{
+    DualStackList ip_addresses;
+
+    detail::ForEachLine(
+        first, last,
+        [&ip_addresses, &malformed](const char* text, const char* line_end)
+        {
+            // No IPv6 form starts with a dotted quad, so IPv4 is
+            // tried first as the common case.
+            if (IPv4 ipv4; ParseIPv4(text, line_end, ipv4))
+            {
+                ip_addresses.ipv4.emplace_back(ipv4);
+            }
+            else if (IPv6 ipv6; ParseIPv6(text, line_end, ipv6))
+            {
+                ip_addresses.ipv6.emplace_back(ipv6);
+            }
+            else if (text != line_end)
+            {
+                ++malformed;
+            }
+        });
+
+    return ip_addresses;
+}
+
+template class BasicReader<IPv4>;
+template class BasicReader<IPv6>;
+template class BasicBufferReader<IPv4>;
+template class BasicBufferReader<IPv6>;
+
+Printer::Printer(std::ostream& os) : output_{os}, buffer_(kBufferSize) {}
+
+void Printer::Print(IpListView ip_list) { PrintAddresses(ip_list); }
+
+void Printer::Print(IPv6ListView ip_list) { PrintAddresses(ip_list); }
+
+template <typename Address>
+void Printer::PrintAddresses(AddressListView<Address> ip_list)
+{
+    ScopedPhase phase{"printer"};
+    phase.AddRowsIn(ip_list.size());
+
+    for (const auto& ip : ip_list)
+    {
+        if (buffer_.size() - buffered_ <= AddressFamily<Address>::kMaxLength)
+        {
+            phase.AddBytesOut(buffered_);
+            WriteBuffer();
+        }
+
+        auto* end =
+            AddressFamily<Address>::Format(ip, buffer_.data() + buffered_);
+        *end++ = '\n';
+
+        buffered_ = static_cast<size_t>(end - buffer_.data());
+    }
+
+    phase.AddBytesOut(buffered_);
+    WriteBuffer();
+    output_.flush();
+}
+
+void Printer::WriteBuffer()
+{
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffered_));
+    buffered_ = 0;
+}
+
 void SortReverseLexicographical(IpList& ip_list)
 {
-    std::sort(ip_list.begin(), ip_list.end(), std::greater<IPv4>());
+    ScopedPhase phase{"sort"};
+    phase.AddRowsIn(ip_list.size());
+
+    if (ip_list.size() < kRadixSortThreshold)
+    {
+        std::sort(ip_list.begin(), ip_list.end(), std::greater<IPv4>());
+        return;
+    }
+
+    RadixSortDescending(ip_list);
+}
+
+void SortReverseLexicographical(IPv6List& ip_list)
+{
+    ScopedPhase phase{"sort"};
+    phase.AddRowsIn(ip_list.size());
+
+    std::sort(ip_list.begin(), ip_list.end(), std::greater<IPv6>());
 }
 
-}  // namespace ip
\ No newline at end of file
+}  // namespace ip
@@ -2,34 +2,182 @@
 
 #include <istream>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "ipv4.hpp"
+#include "ipv6.hpp"
 
 namespace ip
 {
 
-class Reader final
+// Readers are instantiated for IPv4 and IPv6 in utils.cpp; lines starting
+// with an address of the other family count as malformed.
+template <typename Address>
+class BasicReader final
 {
    public:
-    explicit Reader(std::istream& is);
+    explicit BasicReader(std::istream& is);
 
-    IpList ReadFirstIpFromLines();
+    std::vector<Address> ReadFirstIpFromLines();
 
    private:
     std::istream& input_;
 };
 
+template <typename Address>
+class BasicBufferReader final
+{
+   public:
+    // With more than one worker, buffers large enough to be worth it are split
+    // on line boundaries and the chunks are parsed concurrently; the result
+    // keeps the line order.
+    explicit BasicBufferReader(std::string_view buffer,
+                               size_t workers = 1) noexcept;
+
+    std::vector<Address> ReadFirstIpFromLines() const;
+
+   private:
+    // Counts lines that are neither blank nor start with an address.
+    static std::vector<Address> ReadLines(const char* first, const char* last,
+                                          size_t& malformed);
+
+    std::string_view input_;
+    size_t workers_;
+};
+
+using Reader = BasicReader<IPv4>;
+using BufferReader = BasicBufferReader<IPv4>;
+using IPv6Reader = BasicReader<IPv6>;
+using IPv6BufferReader = BasicBufferReader<IPv6>;
+
+// Carries the line split between consecutive blocks of text, so that line
+// parsers read the text as it arrives. Complete lines are handed on straight
+// from each block; only a split line is copied.
+class LineBuffer final
+{
+   public:
+    // Calls read_lines(lines) with the lines the block completes, if any,
+    // newlines included.
+    template <typename ReadLines>
+    void Read(std::string_view block, const ReadLines& read_lines);
+
+    // Calls read_lines(line) with the last line when it has no newline.
+    template <typename ReadLines>
+    void Finish(const ReadLines& read_lines);
+
+   private:
+    std::string carry_;
+};
+
+// Reads consecutive blocks of text as BufferReader reads their concatenation.
+class IncrementalReader final
+{
+   public:
+    void Read(std::string_view block);
+
+    // Reads the last line when it has no newline and returns every address.
+    IpList Finish();
+
+   private:
+    void ReadLines(std::string_view lines);
+
+    IpList ip_addresses_;
+    LineBuffer lines_;
+};
+
+struct DualStackList
+{
+    IpList ipv4;
+    IPv6List ipv6;
+};
+
+// Reads the addresses of both families in a single pass over the buffer,
+// each list keeping the line order.
+class DualStackReader final
+{
+   public:
+    explicit DualStackReader(std::string_view buffer,
+                             size_t workers = 1) noexcept;
+
+    DualStackList ReadFirstIpFromLines() const;
+
+   private:
+    static DualStackList ReadLines(const char* first, const char* last,
+                                   size_t& malformed);
+
+    std::string_view input_;
+    size_t workers_;
+};
+
 class Printer final
 {
    public:
     explicit Printer(std::ostream& os);
 
-    void Print(const IpList& ip_list);
+    // Formats into an internal buffer and hands it to the stream in large
+    // writes; the stream is flushed once per call.
+    void Print(IpListView ip_list);
+
+    void Print(IPv6ListView ip_list);
 
    private:
+    template <typename Address>
+    void PrintAddresses(AddressListView<Address> ip_list);
+
+    void WriteBuffer();
+
+    static constexpr size_t kBufferSize = size_t{64} * 1024;
+
     std::ostream& output_;
+    std::vector<char> buffer_;
+    size_t buffered_{0};
 };
 
 void SortReverseLexicographical(IpList& ip_list);
 
+void SortReverseLexicographical(IPv6List& ip_list);
+
+template <typename ReadLines>
+void LineBuffer::Read(std::string_view block, const ReadLines& read_lines)
+{
+    if (!carry_.empty())
+    {
+        const auto line_end = block.find('\n');
+
+        if (line_end == std::string_view::npos)
+        {
+            carry_.append(block);
+            return;
+        }
+
+        carry_.append(block.substr(0, line_end + 1));
+        read_lines(std::string_view{carry_});
+        carry_.clear();
+        block.remove_prefix(line_end + 1);
+    }
+
+    const auto line_end = block.rfind('\n');
+
+    if (line_end == std::string_view::npos)
+    {
+        carry_.assign(block);
+        return;
+    }
+
+    read_lines(block.substr(0, line_end + 1));
+    carry_.assign(block.substr(line_end + 1));
+}
+
+template <typename ReadLines>
+void LineBuffer::Finish(const ReadLines& read_lines)
+{
+    if (!carry_.empty())
+    {
+        read_lines(std::string_view{carry_});
+        carry_.clear();
+    }
+}
+
 }  // namespace ip
\ No newline at end of file
@@ -3,7 +3,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <random>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "ipv4.hpp"
 
@@ -14,6 +17,7 @@ using namespace std::string_view_literals;
 
 using ip::IpList;
 using ip::IPv4;
+using ip::IPv6;
 using ip::SortReverseLexicographical;
 
 class ReaderTest : public ::testing::Test
@@ -105,6 +109,317 @@ TEST_F(ReaderTest, ShouldReadFirstWordFromLinesWithTabs)
                                        IPv4(255, 255, 255, 255)));
 }
 
+class BufferReaderTest : public ::testing::Test
+{
+   protected:
+    static auto Read(std::string_view input)
+    {
+        return ip::BufferReader{input}.ReadFirstIpFromLines();
+    }
+};
+
+TEST_F(BufferReaderTest, ShouldReadFirstWordFromLinesWithNewlines)
+{
+    // Act
+    const auto result = Read(R"(192.168.1.1
+10.0.0.1
+255.255.255.255
+    )"sv);
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1),
+                                       IPv4(255, 255, 255, 255)));
+}
+
+TEST_F(BufferReaderTest, ShouldReadFirstWordFromLinesWithExtraData)
+{
+    // Act
+    const auto result = Read(R"(192.168.1.1foo bar
+10.0.0.1test
+255.255.255.255
+    )"sv);
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1),
+                                       IPv4(255, 255, 255, 255)));
+}
+
+TEST_F(BufferReaderTest, ShouldSkipInvalidLines)
+{
+    // Act
+    const auto result = Read(R"(1.2.3.
+10.20.30.40
+256.256.256.256
+    )"sv);
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(IPv4(10, 20, 30, 40)));
+}
+
+TEST_F(BufferReaderTest, ShouldHandleEmptyInput)
+{
+    // Act
+    const auto result = Read({});
+
+    // Assert
+    EXPECT_THAT(result, ::testing::IsEmpty());
+}
+
+TEST_F(BufferReaderTest, ShouldReadFirstWordFromLinesWithTabs)
+{
+    // Act
+    const auto result = Read(R"(192.168.1.1 text   text
+10.0.0.1	text    text
+255.255.255.255	text	text
+    )"sv);
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(IPv4(192, 168, 1, 1), IPv4(10, 0, 0, 1),
+                                       IPv4(255, 255, 255, 255)));
+}
+
+TEST_F(BufferReaderTest, ShouldReadLastLineWithoutNewlineAndLeadingSpaces)
+{
+    // Act
+    const auto result = Read("\n  \t10.0.0.1\t1\t2\n 192.168.1.1"sv);
+
+    // Assert
+    EXPECT_THAT(result, ::testing::ElementsAre(IPv4(10, 0, 0, 1),
+                                               IPv4(192, 168, 1, 1)));
+}
+
+TEST_F(BufferReaderTest, ShouldMatchStreamReaderWhenInputIsTsv)
+{
+    // Arrange
+    constexpr auto kInput =
+        "113.162.145.156\t111\t0\n"
+        "bad line\n"
+        "1.2.3\t4\n"
+        "79.180.73.190\t2\t1\n"sv;
+    std::stringstream stream{std::string{kInput}};
+
+    // Act
+    const auto result = Read(kInput);
+
+    // Assert
+    EXPECT_EQ(result, ip::Reader{stream}.ReadFirstIpFromLines());
+}
+
+TEST_F(BufferReaderTest, ShouldRejectSignedFirstOctetUnlikeStreamReader)
+{
+    // Arrange
+    constexpr auto kInput = "+1.2.3.4\tx\n"sv;
+    std::stringstream stream{std::string{kInput}};
+
+    // Act
+    const auto result = Read(kInput);
+
+    // Assert
+    EXPECT_TRUE(result.empty());
+    EXPECT_THAT(ip::Reader{stream}.ReadFirstIpFromLines(),
+                ::testing::ElementsAre(IPv4(1, 2, 3, 4)));
+}
+
+class ParallelBufferReaderTest : public ::testing::TestWithParam<size_t>
+{
+   protected:
+    // Several megabytes of valid, malformed and blank lines, so every worker
+    // gets a chunk and chunk bounds fall in the middle of lines.
+    static std::string MakeInput()
+    {
+        constexpr size_t kLines = 200000;
+        constexpr uint32_t kLineKinds = 5;
+        std::mt19937 engine{3};
+        std::string input;
+
+        for (size_t line = 0; line < kLines; ++line)
+        {
+            const auto ip = IPv4::FromUint32(static_cast<uint32_t>(engine()));
+
+            switch (engine() % kLineKinds)
+            {
+                case 0:
+                    input += "bad line\n";
+                    break;
+                case 1:
+                    input += "\n";
+                    break;
+                case 2:
+                    input += " \t" + static_cast<std::string>(ip) + "\n";
+                    break;
+                default:
+                    input += static_cast<std::string>(ip) + "\t1\t2\n";
+                    break;
+            }
+        }
+
+        return input + "1.2.3.4";
+    }
+};
+
+TEST_P(ParallelBufferReaderTest, ShouldMatchStreamReaderForAnyWorkerCount)
+{
+    // Arrange
+    const auto input = MakeInput();
+    std::stringstream stream{input};
+
+    // Act
+    const auto result =
+        ip::BufferReader{input, GetParam()}.ReadFirstIpFromLines();
+
+    // Assert
+    EXPECT_EQ(result, ip::Reader{stream}.ReadFirstIpFromLines());
+}
+
+INSTANTIATE_TEST_SUITE_P(WorkerCounts, ParallelBufferReaderTest,
+                         ::testing::Values(1, 2, 3, 8, 64));
+
+class IncrementalReaderTest : public ::testing::TestWithParam<size_t>
+{
+};
+
+TEST_P(IncrementalReaderTest, ShouldMatchBufferReaderForAnyBlockSize)
+{
+    // Arrange
+    constexpr auto kInput =
+        "192.168.1.1\t1\t0\n"
+        "bad line\n"
+        "\n"
+        "  10.0.0.1\ttest\n"
+        "256.256.256.256\n"
+        "255.255.255.255 last line without a newline"sv;
+    ip::IncrementalReader reader;
+
+    // Act
+    for (size_t begin = 0; begin < kInput.size(); begin += GetParam())
+    {
+        reader.Read(kInput.substr(begin, GetParam()));
+    }
+
+    // Assert
+    EXPECT_EQ(reader.Finish(), ip::BufferReader{kInput}.ReadFirstIpFromLines());
+}
+
+INSTANTIATE_TEST_SUITE_P(BlockSizes, IncrementalReaderTest,
+                         ::testing::Values(1, 2, 5, 16, 1024));
+
+class LineBufferTest : public ::testing::TestWithParam<size_t>
+{
+};
+
+TEST_P(LineBufferTest, ShouldHandOnWholeLinesInOrder)
+{
+    // Arrange
+    constexpr auto kInput = "first line\n\nthird line\nlast line"sv;
+    ip::LineBuffer lines;
+    std::vector<std::string> runs;
+    const auto read = [&runs](std::string_view text)
+    { runs.emplace_back(text); };
+
+    // Act
+    for (size_t begin = 0; begin < kInput.size(); begin += GetParam())
+    {
+        lines.Read(kInput.substr(begin, GetParam()), read);
+    }
+
+    lines.Finish(read);
+
+    // Assert
+    std::string joined;
+
+    for (const auto& run : runs)
+    {
+        joined += run;
+    }
+
+    EXPECT_EQ(joined, kInput);
+    ASSERT_FALSE(runs.empty());
+    EXPECT_EQ(runs.back(), "last line");
+
+    for (size_t run = 0; run + 1 < runs.size(); ++run)
+    {
+        EXPECT_EQ(runs[run].back(), '\n');
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(BlockSizes, LineBufferTest,
+                         ::testing::Values(1, 2, 5, 16, 1024));
+
+TEST(IPv6BufferReaderTest, ShouldReadIPv6LinesAndSkipIPv4Lines)
+{
+    // Arrange
+    constexpr auto kInput = R"(2001:db8::1	1	2
+10.0.0.1	1	2
+  ::ffff:10.0.0.1
+fe80:::1
+)"sv;
+
+    // Act
+    const auto result = ip::IPv6BufferReader{kInput}.ReadFirstIpFromLines();
+
+    // Assert
+    EXPECT_THAT(result,
+                ::testing::ElementsAre(
+                    IPv6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 1}),
+                    IPv6({0, 0, 0, 0, 0, 0xffff, 0x0a00, 0x0001})));
+}
+
+class DualStackReaderTest : public ::testing::TestWithParam<size_t>
+{
+   protected:
+    static std::string MakeInput()
+    {
+        constexpr size_t kLines = 200000;
+        constexpr uint32_t kLineKinds = 4;
+        std::mt19937_64 engine{5};
+        std::string input;
+
+        for (size_t line = 0; line < kLines; ++line)
+        {
+            switch (engine() % kLineKinds)
+            {
+                case 0:
+                    input += "bad line\n";
+                    break;
+                case 1:
+                    input += static_cast<std::string>(IPv4::FromUint32(
+                                 static_cast<uint32_t>(engine()))) +
+                             "\t1\t2\n";
+                    break;
+                default:
+                    input += static_cast<std::string>(
+                                 IPv6::FromWords(engine(), engine())) +
+                             "\t1\t2\n";
+                    break;
+            }
+        }
+
+        return input;
+    }
+};
+
+TEST_P(DualStackReaderTest, ShouldMatchSingleFamilyReadersInOnePass)
+{
+    // Arrange
+    const auto input = MakeInput();
+    std::stringstream ipv4_stream{input};
+    std::stringstream ipv6_stream{input};
+
+    // Act
+    const auto result =
+        ip::DualStackReader{input, GetParam()}.ReadFirstIpFromLines();
+
+    // Assert
+    EXPECT_EQ(result.ipv4, ip::Reader{ipv4_stream}.ReadFirstIpFromLines());
+    EXPECT_EQ(result.ipv6, ip::IPv6Reader{ipv6_stream}.ReadFirstIpFromLines());
+}
+
+INSTANTIATE_TEST_SUITE_P(WorkerCounts, DualStackReaderTest,
+                         ::testing::Values(1, 3, 8));
+
 class PrinterTest : public ::testing::Test
 {
    protected:
@@ -127,6 +442,41 @@ TEST_F(PrinterTest, ShouldPrintIpListWhenListIsNotEmpty)
 )"sv);
 }
 
+TEST_F(PrinterTest, ShouldPrintEveryLineWhenOutputExceedsBuffer)
+{
+    // Arrange
+    constexpr size_t kSize = 20000;
+    const IpList ips(kSize, IPv4(255, 255, 255, 255));
+
+    // Act
+    Print(ips);
+
+    // Assert
+    std::string expected;
+
+    for (size_t i = 0; i < kSize; ++i)
+    {
+        expected += "255.255.255.255\n";
+    }
+
+    EXPECT_EQ(oss.str(), expected);
+}
+
+TEST_F(PrinterTest, ShouldPrintCanonicalFormWhenListIsIPv6)
+{
+    // Arrange
+    const ip::IPv6List ips{IPv6({0x2001, 0xdb8, 0, 0, 0, 0, 0, 1}),
+                           IPv6({0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+                                 0xffff, 0xffff, 0xffff})};
+
+    // Act
+    printer.Print(ips);
+
+    // Assert
+    EXPECT_EQ(oss.str(),
+              "2001:db8::1\nffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff\n"sv);
+}
+
 TEST_F(PrinterTest, ShouldPrintNothingWhenListIsEmpty)
 {
     // Act
@@ -178,4 +528,35 @@ TEST(SortingTest, ShouldSortEmptyListWhenListIsEmpty)
     EXPECT_THAT(ips, IsSorted(std::greater<ip::IPv4>()));
 }
 
+TEST(SortingTest, ShouldMatchComparisonSortWhenListIsLarge)
+{
+    // Arrange
+    constexpr size_t kSize = 100000;
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> octet{0, 255};
+    // Narrow ranges in the leading octets keep runs of equal keys and make
+    // the radix sort skip passes where all addresses share a byte.
+    std::uniform_int_distribution<int> leading_octet{45, 47};
+
+    IpList ips;
+    ips.reserve(kSize);
+
+    for (size_t i = 0; i < kSize; ++i)
+    {
+        ips.emplace_back(static_cast<uint8_t>(leading_octet(generator)), 70,
+                         static_cast<uint8_t>(octet(generator)),
+                         static_cast<uint8_t>(octet(generator)));
+    }
+
+    auto expected = ips;
+    std::sort(expected.begin(), expected.end(), std::greater<IPv4>());
+
+    // Act
+    SortReverseLexicographical(ips);
+
+    // Assert
+    EXPECT_EQ(ips, expected);
+}
+
 }  // namespace
\ No newline at end of file
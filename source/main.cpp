@@ -1,30 +1,792 @@
+#include <pthread.h>
+#include <signal.h>
+
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "ip/arena.hpp"
+#include "ip/async_reader.hpp"
+#include "ip/compression.hpp"
+#include "ip/distinct.hpp"
 #include "ip/filter.hpp"
+#include "ip/hyperloglog.hpp"
+#include "ip/ipv6.hpp"
+#include "ip/mapped_file.hpp"
+#include "ip/query.hpp"
+#include "ip/server.hpp"
+#include "ip/snapshot.hpp"
+#include "ip/stats.hpp"
+#include "ip/stream.hpp"
 #include "ip/utils.hpp"
 
-int main([[maybe_unused]] int arg, [[maybe_unused]] char** args)
+namespace
 {
-    ip::Reader reader{std::cin};
 
-    ip::Printer printer{std::cout};
+constexpr size_t kDefaultRunSize = size_t{1} << 24;
+// Enough leading bytes to recognise a compressed input.
+constexpr size_t kMagicSize = 4;
+
+// Printed after the whole sorted list when no --query is given.
+constexpr std::string_view kDefaultQueries[] = {"o1=1", "o1=46 and o2=70",
+                                                "any=46"};
+
+enum class Family
+{
+    kIPv4,
+    kIPv6,
+    // Both families read in one pass, the IPv4 output first.
+    kAll
+};
+
+struct Options
+{
+    // Prints every address in input order without holding the whole input.
+    bool stream{false};
+    // With --stream, sorts the output using spilled runs of run_size
+    // addresses.
+    bool sort{false};
+    size_t run_size{kDefaultRunSize};
+    std::optional<std::string> path;
+    // Reads the addresses from a binary snapshot instead of text.
+    std::optional<std::string> snapshot;
+    // Saves the sorted addresses as a binary snapshot for later runs.
+    std::optional<std::string> write_snapshot;
+    // Each query prints its matches in turn; with --stream at most one
+    // query filters the stream.
+    std::vector<ip::Query> queries;
+    // Writes a JSON summary of every phase to stderr, as IP_FILTER_STATS
+    // does.
+    bool stats{false};
+    // Drops repeated addresses before sorting, so each is printed once.
+    bool unique{false};
+    // Prints every distinct address with its line count and the sums of the
+    // second and third columns instead of the address lists.
+    bool aggregate{false};
+    // Prints an approximate count of distinct addresses, reading the input
+    // in bounded memory.
+    bool distinct{false};
+    Family family{Family::kIPv4};
+    // Each prefix prints its IPv6 matches in turn after the IPv6 list.
+    std::vector<ip::IPv6Prefix> prefixes;
+    // Loads the input once and answers queries on this Unix socket until
+    // SIGINT or SIGTERM; SIGHUP reloads the input file or snapshot.
+    std::optional<std::string> serve;
+    // Reads the input file with several reads in flight, parsing each block
+    // while the next ones are read, instead of mapping it. Compressed files
+    // are still mapped and decompressed, on one thread apart from zstd input
+    // of several frames.
+    bool async_read{false};
+};
+
+std::optional<Options> ParseOptions(int arg, char** args)
+{
+    Options options;
+
+    for (int index = 1; index < arg; ++index)
+    {
+        const std::string_view option{args[index]};
+
+        if (option == "--stream")
+        {
+            options.stream = true;
+        }
+        else if (option == "--sort")
+        {
+            options.sort = true;
+        }
+        else if (option == "--stats")
+        {
+            options.stats = true;
+        }
+        else if (option == "--unique")
+        {
+            options.unique = true;
+        }
+        else if (option == "--aggregate")
+        {
+            options.aggregate = true;
+        }
+        else if (option == "--distinct")
+        {
+            options.distinct = true;
+        }
+        else if (option == "--async-read")
+        {
+            options.async_read = true;
+        }
+        else if (option == "--run-size" && index + 1 < arg)
+        {
+            const std::string_view value{args[++index]};
+            const auto [end, error] = std::from_chars(
+                value.data(), value.data() + value.size(), options.run_size);
+
+            if (error != std::errc{} || end != value.data() + value.size() ||
+                options.run_size == 0)
+            {
+                std::cerr << "Invalid run size: " << value << '\n';
+
+                return std::nullopt;
+            }
+        }
+        else if (option == "--query" && index + 1 < arg)
+        {
+            try
+            {
+                options.queries.push_back(ip::Query::Parse(args[++index]));
+            }
+            catch (const std::invalid_argument& error)
+            {
+                std::cerr << error.what() << '\n';
+
+                return std::nullopt;
+            }
+        }
+        else if (option == "--family" && index + 1 < arg)
+        {
+            const std::string_view value{args[++index]};
+
+            if (value == "4")
+            {
+                options.family = Family::kIPv4;
+            }
+            else if (value == "6")
+            {
+                options.family = Family::kIPv6;
+            }
+            else if (value == "all")
+            {
+                options.family = Family::kAll;
+            }
+            else
+            {
+                std::cerr << "Invalid family: " << value << '\n';
+
+                return std::nullopt;
+            }
+        }
+        else if (option == "--prefix" && index + 1 < arg)
+        {
+            try
+            {
+                options.prefixes.push_back(ip::ParseIPv6Prefix(args[++index]));
+            }
+            catch (const std::invalid_argument& error)
+            {
+                std::cerr << error.what() << '\n';
+
+                return std::nullopt;
+            }
+        }
+        else if (option == "--serve" && index + 1 < arg)
+        {
+            options.serve = args[++index];
+        }
+        else if (option == "--snapshot" && index + 1 < arg)
+        {
+            options.snapshot = args[++index];
+        }
+        else if (option == "--write-snapshot" && index + 1 < arg)
+        {
+            options.write_snapshot = args[++index];
+        }
+        else if (option.empty() || option.front() == '-')
+        {
+            std::cerr << "Unknown option: " << option << '\n';
+
+            return std::nullopt;
+        }
+        else
+        {
+            options.path = option;
+        }
+    }
+
+    if (options.stream && options.queries.size() > 1)
+    {
+        std::cerr << "--stream takes at most one --query\n";
+
+        return std::nullopt;
+    }
+
+    if (options.stream && options.unique)
+    {
+        std::cerr << "--unique needs the whole input, use --distinct with "
+                     "--stream\n";
+
+        return std::nullopt;
+    }
+
+    if (options.family != Family::kIPv4 &&
+        (options.stream || options.snapshot || options.write_snapshot ||
+         options.distinct || options.aggregate))
+    {
+        std::cerr << "--stream, --snapshot, --write-snapshot, --distinct and "
+                     "--aggregate read IPv4 only\n";
 
-    auto input_ips = reader.ReadFirstIpFromLines();
+        return std::nullopt;
+    }
+
+    if (options.serve &&
+        (options.stream || options.distinct || options.aggregate ||
+         options.write_snapshot || options.family != Family::kIPv4 ||
+         !options.queries.empty()))
+    {
+        std::cerr << "--serve takes only an input, --snapshot and --unique\n";
+
+        return std::nullopt;
+    }
+
+    if (options.async_read &&
+        (!options.path || options.stream || options.distinct ||
+         options.aggregate || options.family != Family::kIPv4))
+    {
+        std::cerr << "--async-read reads an IPv4 input file\n";
+
+        return std::nullopt;
+    }
+
+    if ((options.family == Family::kIPv6 && !options.queries.empty()) ||
+        (options.family == Family::kIPv4 && !options.prefixes.empty()))
+    {
+        std::cerr << "--query filters IPv4 and --prefix filters IPv6\n";
+
+        return std::nullopt;
+    }
+
+    return options;
+}
+
+// Reads the magic number and rewinds the file.
+ip::Compression DetectFileCompression(std::ifstream& file)
+{
+    std::array<char, kMagicSize> magic{};
+    file.read(magic.data(), magic.size());
+
+    const std::string_view head{magic.data(),
+                                static_cast<size_t>(file.gcount())};
+
+    file.clear();
+    file.seekg(0);
+
+    return ip::DetectCompression(head);
+}
 
-    ip::Filter filter{input_ips};
+ip::IpList ReadInput(const Options& options)
+{
+    if (options.async_read)
+    {
+        std::ifstream file{*options.path, std::ios::binary};
 
-    ip::SortReverseLexicographical(input_ips);
+        // A file that cannot be opened fails in ReadFirstIpFromFile.
+        if (DetectFileCompression(file) == ip::Compression::kNone)
+        {
+            return ip::ReadFirstIpFromFile(*options.path);
+        }
+    }
 
-    const auto filtered_by_one_octet = filter.FilterByMask({1});
+    if (options.path)
+    {
+        const ip::MappedFile file{*options.path};
 
-    const auto filtered_by_two_octets = filter.FilterByMask({46, 70});
+        // gzip and zstd files are decompressed while the text is parsed.
+        // Decoding is parallel only across the frames of multi-frame zstd
+        // input; gzip and single-frame zstd are decoded by one worker.
+        ip::DecompressOptions decompress;
+        decompress.workers = std::thread::hardware_concurrency();
+
+        return ip::ReadFirstIpFromCompressed(file.View(), decompress);
+    }
+
+    return ip::Reader{std::cin}.ReadFirstIpFromLines();
+}
+
+void SortInput(const Options& options, ip::IpList& ips)
+{
+    // Hashing out the repeats first leaves less to sort.
+    if (options.unique)
+    {
+        ip::Deduplicate(ips);
+    }
+
+    ip::SortReverseLexicographical(ips);
+}
+
+ip::IpList CopySnapshot(const Options& options, const ip::Snapshot& snapshot)
+{
+    ip::IpList ips(snapshot.View().begin(), snapshot.View().end());
+
+    if (!snapshot.IsSorted())
+    {
+        ip::SortReverseLexicographical(ips);
+    }
+
+    if (options.unique)
+    {
+        ip::DeduplicateSorted(ips);
+    }
+
+    return ips;
+}
+
+ip::IpList ReadSortedInput(const Options& options)
+{
+    ip::ScopedPhase phase{"input"};
+
+    if (options.snapshot)
+    {
+        auto ips = CopySnapshot(options, ip::Snapshot{*options.snapshot});
+        phase.AddRowsOut(ips.size());
+
+        return ips;
+    }
+
+    auto ips = ReadInput(options);
+
+    SortInput(options, ips);
+    phase.AddRowsOut(ips.size());
+
+    return ips;
+}
+
+// Hands the input text on in runs of whole lines: the mapped file at once,
+// compressed files as they are decompressed, or all of stdin.
+template <typename ReadLines>
+void ReadText(const Options& options, const ReadLines& read_lines)
+{
+    ip::LineBuffer lines;
+
+    if (options.path)
+    {
+        const ip::MappedFile file{*options.path};
+
+        ip::DecompressOptions decompress;
+        decompress.workers = std::thread::hardware_concurrency();
+
+        ip::DecompressBlocks(
+            file.View(),
+            [&lines, &read_lines](std::string_view block)
+            { lines.Read(block, read_lines); },
+            decompress);
+    }
+    else
+    {
+        const std::string text{std::istreambuf_iterator<char>{std::cin},
+                               std::istreambuf_iterator<char>{}};
+
+        lines.Read(text, read_lines);
+    }
+
+    lines.Finish(read_lines);
+}
+
+// Moves instead of copying the first part, which is all of a mapped file.
+template <typename List>
+void Append(List& list, List&& part)
+{
+    if (list.empty())
+    {
+        list = std::move(part);
+        return;
+    }
+
+    list.insert(list.end(), part.cbegin(), part.cend());
+}
+
+ip::DualStackList ReadDualStackInput(const Options& options)
+{
+    ip::ScopedPhase phase{"input"};
+
+    const auto workers = std::thread::hardware_concurrency();
+    ip::DualStackList lists;
+
+    ReadText(options,
+             [&options, workers, &lists](std::string_view text)
+             {
+                 ip::DualStackList read;
+
+                 if (options.family == Family::kIPv6)
+                 {
+                     read.ipv6 = ip::IPv6BufferReader{text, workers}
+                                     .ReadFirstIpFromLines();
+                 }
+                 else
+                 {
+                     read = ip::DualStackReader{text, workers}
+                                .ReadFirstIpFromLines();
+                 }
+
+                 Append(lists.ipv4, std::move(read.ipv4));
+                 Append(lists.ipv6, std::move(read.ipv6));
+             });
+
+    SortInput(options, lists.ipv4);
+    ip::SortReverseLexicographical(lists.ipv6);
+
+    if (options.unique)
+    {
+        ip::DeduplicateSorted(lists.ipv6);
+    }
+
+    phase.AddRowsOut(lists.ipv4.size() + lists.ipv6.size());
+
+    return lists;
+}
+
+std::ifstream OpenInput(const Options& options)
+{
+    std::ifstream file;
+
+    if (options.path)
+    {
+        file.open(*options.path, std::ios::binary);
+
+        if (!file)
+        {
+            throw std::runtime_error{"Failed to open " + *options.path};
+        }
+
+        if (DetectFileCompression(file) != ip::Compression::kNone)
+        {
+            throw std::runtime_error{
+                "Compressed input is read without --stream and --distinct"};
+        }
+    }
+
+    return file;
+}
+
+ip::Filter::Predicate StreamPredicate(const Options& options)
+{
+    return options.queries.empty()
+               ? ip::Filter::Predicate{[](const ip::IPv4&) { return true; }}
+               : ip::Filter::Predicate{options.queries.front()};
+}
+
+void Stream(const Options& options, ip::Printer& printer)
+{
+    ip::ScopedPhase phase{"stream"};
+    auto file = OpenInput(options);
 
-    const auto filtered_by_any_octet = filter.FilterByOctetValue(46);
+    std::istream& input = options.path ? file : std::cin;
+    const auto accept = StreamPredicate(options);
+    const auto print = [&printer](ip::IpListView batch)
+    { printer.Print(batch); };
+
+    if (!options.sort)
+    {
+        ip::StreamFilter(input, accept, print);
+
+        return;
+    }
+
+    ip::ExternalSorter sorter{options.run_size};
+
+    ip::StreamFilter(input, accept,
+                     [&sorter](ip::IpListView batch) { sorter.Add(batch); });
+
+    sorter.Finish(print);
+}
+
+void CountDistinct(const Options& options, std::ostream& output)
+{
+    ip::ScopedPhase phase{"distinct"};
+    auto file = OpenInput(options);
+
+    std::istream& input = options.path ? file : std::cin;
+    ip::HyperLogLog counter;
+
+    ip::StreamFilter(input, StreamPredicate(options),
+                     [&counter](ip::IpListView batch) { counter.Add(batch); });
+
+    output << counter.Estimate() << '\n';
+}
+
+void Aggregate(const Options& options, std::ostream& output)
+{
+    ip::ScopedPhase phase{"aggregate"};
+
+    ip::ColumnAggregator aggregator;
+
+    ReadText(options,
+             [&phase, &aggregator](std::string_view text)
+             {
+                 phase.AddBytesIn(text.size());
+                 aggregator.Read(text);
+             });
+
+    const auto aggregates = aggregator.Finish();
+
+    phase.AddRowsOut(aggregates.size());
+
+    for (const auto& aggregate : aggregates)
+    {
+        output << std::string{aggregate.ip} << '\t' << aggregate.lines
+               << '\t' << aggregate.second_column_sum << '\t'
+               << aggregate.third_column_sum << '\n';
+    }
+}
+
+// Sorted-range results are slices of `ips`, the others live in `arena`; no
+// result is copied once more for printing.
+ip::IpListView RunQuery(const ip::Query& query, ip::IpListView ips,
+                        ip::IpArena& arena)
+{
+    ip::ScopedPhase phase{"query"};
+    phase.AddRowsIn(ips.size());
+
+    const auto result =
+        query.Run(ips, true, std::thread::hardware_concurrency(), arena);
+
+    phase.AddRowsOut(result.size());
+
+    return result;
+}
+
+void PrintIPv4(const Options& options, ip::IpListView input_ips,
+               ip::Printer& printer)
+{
+    if (options.write_snapshot)
+    {
+        ip::WriteSnapshot(*options.write_snapshot, input_ips);
+    }
+
+    // Each result is printed before the next query runs, so the arena only
+    // ever holds one of them.
+    ip::IpArena arena;
+
+    if (!options.queries.empty())
+    {
+        for (const auto& query : options.queries)
+        {
+            printer.Print(RunQuery(query, input_ips, arena));
+            arena.Reset();
+        }
+
+        return;
+    }
+
+    printer.Print(input_ips);
+
+    for (const auto text : kDefaultQueries)
+    {
+        printer.Print(RunQuery(ip::Query::Parse(text), input_ips, arena));
+        arena.Reset();
+    }
+}
+
+// A sorted snapshot is queried and printed where it is mapped. It is copied
+// only to be sorted or deduplicated, or when --write-snapshot would truncate
+// the mapped file.
+void PrintSnapshot(const Options& options, ip::Printer& printer)
+{
+    std::optional<ip::Snapshot> snapshot;
+    ip::IpList copy;
+    ip::IpListView ips;
+
+    {
+        ip::ScopedPhase phase{"input"};
+        snapshot.emplace(*options.snapshot);
+
+        std::error_code error;
+        const bool overwritten =
+            options.write_snapshot &&
+            std::filesystem::equivalent(*options.snapshot,
+                                        *options.write_snapshot, error);
+
+        if (snapshot->IsSorted() && !options.unique && !overwritten)
+        {
+            ips = snapshot->View();
+        }
+        else
+        {
+            copy = CopySnapshot(options, *snapshot);
+            ips = copy;
+        }
+
+        phase.AddRowsOut(ips.size());
+    }
+
+    PrintIPv4(options, ips, printer);
+}
+
+void PrintDualStack(const Options& options, ip::Printer& printer)
+{
+    const auto lists = ReadDualStackInput(options);
+
+    if (options.family == Family::kAll)
+    {
+        PrintIPv4(options, lists.ipv4, printer);
+    }
+
+    printer.Print(lists.ipv6);
+
+    // A prefix is one contiguous range of the sorted list.
+    for (const auto& prefix : options.prefixes)
+    {
+        printer.Print(ip::FindPrefix(lists.ipv6, prefix));
+    }
+}
+
+void Serve(const Options& options)
+{
+    // Blocked before any thread starts, so that every thread inherits the
+    // mask and only the signal thread below receives them.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    ip::QueryServer server{*options.serve, ReadSortedInput(options),
+                           std::thread::hardware_concurrency()};
+    std::exception_ptr serve_error;
+
+    std::thread signal_thread{
+        [&options, &server, &signals]
+        {
+            for (int signal = 0; sigwait(&signals, &signal) == 0;)
+            {
+                if (signal != SIGHUP)
+                {
+                    break;
+                }
+
+                // Standard input was consumed by the first load.
+                if (!options.path && !options.snapshot)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    server.Reload(ReadSortedInput(options));
+                }
+                catch (const std::exception& error)
+                {
+                    // A failed reload keeps serving the loaded list.
+                    std::cerr << "Reload failed: " << error.what() << '\n';
+                }
+            }
+
+            server.Stop();
+        }};
+
+    try
+    {
+        server.Serve();
+    }
+    catch (...)
+    {
+        serve_error = std::current_exception();
+    }
+
+    // Wakes the signal thread when serving ended on an error.
+    pthread_kill(signal_thread.native_handle(), SIGTERM);
+    signal_thread.join();
+
+    if (serve_error)
+    {
+        std::rethrow_exception(serve_error);
+    }
+}
+
+void Run(const Options& options, ip::Printer& printer)
+{
+    if (options.serve)
+    {
+        Serve(options);
+
+        return;
+    }
+
+    if (options.distinct)
+    {
+        CountDistinct(options, std::cout);
+
+        return;
+    }
+
+    if (options.aggregate)
+    {
+        Aggregate(options, std::cout);
+
+        return;
+    }
+
+    if (options.stream)
+    {
+        Stream(options, printer);
+
+        return;
+    }
+
+    if (options.family != Family::kIPv4)
+    {
+        PrintDualStack(options, printer);
+
+        return;
+    }
+
+    if (options.snapshot)
+    {
+        PrintSnapshot(options, printer);
+
+        return;
+    }
+
+    PrintIPv4(options, ReadSortedInput(options), printer);
+}
+
+}  // namespace
+
+int main(int arg, char** args)
+{
+    std::ios::sync_with_stdio(false);
+
+    const auto options = ParseOptions(arg, args);
+
+    if (!options)
+    {
+        return 1;
+    }
+
+    if (options->stats)
+    {
+        ip::Stats::Enable(true);
+    }
+
+    ip::Printer printer{std::cout};
+
+    try
+    {
+        const ip::ScopedPhase phase{"total"};
+
+        Run(*options, printer);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+
+        return EXIT_FAILURE;
+    }
 
-    for (const auto& ips :
-         std::array{input_ips, filtered_by_one_octet, filtered_by_two_octets,
-                    filtered_by_any_octet})
+    if (ip::Stats::Enabled())
     {
-        printer.Print(ips);
+        ip::Stats::WriteJson(std::cerr);
     }
-}
\ No newline at end of file
+}